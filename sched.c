@@ -1,16 +1,19 @@
 /*******************************************************************************
  * sched.c      Author: Ian Nobile
  *
- * This memory-leak free program simulates either the Non-Preemptive Priority
- * (NPP) or Round Robin (RR) algorithms of a CPU scheduler based on user input,
- * and must be invoked via the command line as follows:
+ * This memory-leak free program simulates the Non-Preemptive Priority (NPP),
+ * Round Robin (RR), First-Come First-Served (FCFS), Shortest Job First (SJF),
+ * Preemptive Priority (PP), Shortest Remaining Time First (SRTF) or
+ * Multi-Level Feedback Queue (MLFQ) algorithms of a CPU scheduler based on
+ * user input, and must be invoked via the command line as follows:
  *
- *    ./sched <input filepath> <output filepath> <NPP or RR>
- *    [quantum(RR only)] [limit(optional)]
+ *    ./sched <input filepath> <output filepath>
+ *    <NPP, RR, FCFS, SJF, PP, SRTF or MLFQ> [quantum(RR and MLFQ only)]
+ *    [limit(optional)]
  *
  *
- * Note that if RR is specified as the <algorithm>, then a positive integer
- * [quantum] value must also be provided as a command line argument
+ * Note that if RR or MLFQ is specified as the <algorithm>, then a positive
+ * integer [quantum] value must also be provided as a command line argument
  * representing the length of the time quantum (time slice). A results file
  * called "out.txt" will appear at the location specified by the user, and each
  * line of this results file will contain a different process from the
@@ -18,401 +21,5477 @@
  *
  *    <pid> <arrival-time> <finish-time> <waiting-time>
  *
+ * Given --binary anywhere on the command line, the results file is instead
+ * written as a header followed by those four values per process and then its
+ * preemptions, -1 unless --switch was given, as packed native 64-bit ints.
+ * Given --stream, an input file sorted by arrival is read only as the
+ * simulation reaches each arrival, and each result is written the
+ * moment its process finishes, so memory tracks the ready queue rather than
+ * the size of the input file. Otherwise, a text input file of more than a few
+ * megabytes is parsed and sorted by arrival on --threads=N threads (all cores
+ * by default), with the same results, ties included, as on one.
  *
- * In the case of arrival ties, FCFS’s rule is used to break the tie in NPP and
- * new processes are put in the ready queue immediately after the process whose
- * time quantum has just expired while simulating RR. All units will be in
- * milliseconds, and all values, integers.
+ * Given --cpus=N, the processes are scheduled over N CPUs, each with its own
+ * ready queue from which idle CPUs steal, or with --global all sharing one,
+ * and the time each CPU spent busy is reported alongside the averages. Slices
+ * ending at the same instant are taken in CPU order. RR skips the rounds of
+ * each CPU's own ring that nothing from outside it can interrupt, as on one
+ * CPU, but under --global every slice is simulated. The preemptive
+ * algorithms, PP, SRTF and MLFQ, run on a single CPU only, and are refused
+ * with --cpus greater than 1.
+ *
+ * MLFQ admits every process at the top of --levels=N queues (3 by default),
+ * where the quantum is [quantum], doubling at each level down. A process that
+ * uses up its quantum drops a level, one arriving above the running process
+ * preempts it, and every --boost=MS milliseconds (ten of the longest quanta
+ * by default, never if negative) all waiting processes return to the top.
+ *
+ * Given --switch=MS, every time the CPU moves from one process to another it
+ * first spends MS milliseconds switching, the number of switches and the time
+ * lost to them are reported, and each line of a text results file ends with
+ * the number of times that process was switched out before it finished:
+ *
+ *    <pid> <arrival-time> <finish-time> <waiting-time> <preemptions>
+ *
+ * Besides the averages, every run reports the median, 90th, 99th and 99.9th
+ * percentile waiting, turnover and response (arrival to first dispatch)
+ * times, the processes finished per millisecond, the time the CPUs sat idle
+ * and the most processes ever ready at once. The percentiles come from a
+ * fixed-size histogram, exact below 256 ms and otherwise within 1% above.
+ *
+ * Given --timeline=FILE, every arrival, slice, completion and context switch
+ * of the run is also written to FILE as Chrome trace JSON, to be opened in
+ * Perfetto or chrome://tracing with a track per CPU; the rounds RR works out
+ * at once show as a single "RR rounds" span instead of a slice each, its args
+ * giving how many processes took part and how many rounds of them were run,
+ * with the completions among them inside it. A build with
+ * SCHED_NO_TIMELINE defined records nothing and refuses the option.
+ *
+ * Given --profile, the time spent parsing the input, sorting it by arrival,
+ * simulating and exporting the results is reported phase by phase, and on
+ * Linux, where the kernel allows it, so are the cycles, cache misses and
+ * branch misses of each.
+ *
+ *
+ * A text input file can also be converted once into a binary trace, which
+ * may then be given as the <input filepath> of any later run and is mapped
+ * straight into memory instead of being parsed:
+ *
+ *    ./sched convert <input filepath> <trace filepath>
+ *
+ * To tune the time quantum, a sweep loads the input once and simulates NPP
+ * and RR for every quantum from <first> to <last> in parallel, on --threads=N
+ * worker threads (all cores by default), writing one summary line per run
+ * and reporting the quantum with the highest throughput for the --switch=MS
+ * cost given:
+ *
+ *    ./sched sweep <input filepath> <summary filepath> <first> <last>
+ *
+ *    <algorithm> <quantum> <processes> <average-wait> <average-turnover>
+ *    <switches> <switch-time> <finish-time-of-last>
+ *
+ * Many runs can likewise be made in one process from a manifest listing a
+ * job per line, spread over the same --threads=N workers and each run with
+ * the --binary, --levels, --boost and --switch options given, with one
+ * summary line per job written in manifest order, its <input filepath>
+ * first and "failed" in place of the figures if it could not be run:
+ *
+ *    ./sched batch <manifest filepath> <summary filepath>
+ *
+ *    <input filepath> <output filepath> <algorithm> [quantum] [limit]
+ *
+ * To measure the simulator itself, a benchmark generates a synthetic trace
+ * from --seed=N (1 by default) for every size from <first> to <last>
+ * processes (1000 to 1000000 by default), ten times larger at each step,
+ * and reports the time taken to load it and, for every algorithm, to
+ * simulate it with [quantum] (4 by default) and write the results, the
+ * nanoseconds per event and the peak memory used. The results of runs of up
+ * to 10000 processes are checked against a tick-by-tick reference, and the
+ * benchmark exits with 1 if any of them differ. The same traces can also be
+ * written out on their own:
+ *
+ *    ./sched bench [first] [last] [quantum]
+ *    ./sched generate <count> <output filepath>
+ *
+ *
+ * Compiled with SCHED_NO_MAIN defined, the program leaves out main() and
+ * becomes a library, declared in sched.h, through which another program can
+ * submit processes to a simulation as they arrive, advance it to any time,
+ * and be told of each finish, without files and without simulating any
+ * stretch twice. Such a simulation can be checkpointed wherever an advance
+ * stops, and restored from the checkpoint as often as there are what-ifs to
+ * follow from it.
+ *
+ *
+ * In the case of arrival ties, FCFS’s rule is used to break the tie in NPP,
+ * SJF, PP and SRTF, where a running process is preempted only by an arrival
+ * that strictly outranks it, and new processes are put in the ready queue
+ * immediately after the process whose time quantum has just expired while
+ * simulating RR. All units will be in milliseconds, and all values, integers.
+ *
+ * Before anything is simulated, the input is checked in one pass: a file
+ * holding no processes, fewer than the [limit] asked for (itself a positive
+ * integer), a negative burst time or a pid given twice is refused, as is any
+ * line not of the input format. A streamed input, only read as it is
+ * simulated, is checked as it goes, for everything but repeated pids, and
+ * if it fails, the results file written meanwhile is deleted. The program
+ * exits with 0 after a run, and otherwise with a status telling what
+ * stopped it:
+ *
+ *    1  a command line, file or option the program could not use
+ *    2  a missing or non-positive [quantum]
+ *    3  a malformed line or binary trace
+ *    4  an input holding no processes
+ *    5  an input holding fewer processes than the [limit]
+ *    6  a pid given twice
+ *    7  a negative burst time
+ *    8  a streamed input not sorted by arrival
+ *
+ * At a terminal the program waits for Enter before exiting, unless given
+ * --no-pause; run from a script or with its input redirected, it never does.
  *
 *******************************************************************************/
 
+//  POSIX, for clock_gettime(), and syscall() for perf_event_open, even when
+//  compiled under a strict standard such as -std=c11 rather than a gnu one
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+//  the vector kernels are built for AVX2 wherever the compiler can target it,
+//  to be used once the CPU is seen to support it, and for NEON where that is
+//  always there; a build with SCHED_NO_SIMD defined keeps to the scalar loops
+#ifndef SCHED_NO_SIMD
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SCHED_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define SCHED_NEON
+#include <arm_neon.h>
+#endif
+#endif
+#include "sched.h"
+
+//  the exit status of a run that fails: 1 for anything amiss with the command
+//  line or the files named on it, and otherwise one for each way the input
+//  itself can be turned away
+#define FAIL_QUANTUM 2
+#define FAIL_MALFORMED 3
+#define FAIL_EMPTY 4
+#define FAIL_SHORT 5
+#define FAIL_DUPLICATE 6
+#define FAIL_NEGATIVE 7
+#define FAIL_UNSORTED 8
+
+//  size of each block read from a text trace, which is also the least a
+//  thread parsing one in parallel is given, and the fewest processes each
+//  thread sorting them in parallel is given
+#define LOAD_BLOCK (1 << 20)
+#define SORT_BLOCK (1 << 16)
+
+//  identifies a binary trace written by ./sched convert, a binary results
+//  file written with --binary, and a checkpoint of a live simulation
+#define TRACE_MAGIC "SCHEDTRC"
+#define TRACE_VERSION 1
+#define RESULTS_MAGIC "SCHEDOUT"
+#define RESULTS_VERSION 3
+#define CHECKPOINT_MAGIC "SCHEDCKP"
+#define CHECKPOINT_VERSION 1
+
+//  size of the buffer the results are formatted into before each write
+#define WRITE_BLOCK (1 << 20)
+
+//  a histogram counts values exactly below 2 << HISTOGRAM_BITS, and above
+//  that in buckets 1 / (1 << HISTOGRAM_BITS) of a power of two wide
+#define HISTOGRAM_BITS 7
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_BITS) << HISTOGRAM_BITS)
+
+//  the events a timeline holds in memory before spilling them to its log, and
+//  the kinds of event it records
+#define TIMELINE_BLOCK (1 << 16)
+#define EVENT_ARRIVAL 0
+#define EVENT_SLICE 1
+#define EVENT_FINISH 2
+#define EVENT_SWITCH 3
+#define EVENT_ROUNDS 4
+
+//  the phases --profile times, and the hardware counters it reads in each
+#define PROFILE_PARSE 0
+#define PROFILE_SORT 1
+#define PROFILE_SIMULATE 2
+#define PROFILE_EXPORT 3
+#define PROFILE_PHASES 4
+#define PROFILE_COUNTERS 3
+
+//  a benchmark's arrivals are a Poisson process of 0.25 per ms, e^-0.25 being
+//  the chance of a ms without any, and runs of up to BENCH_CHECK processes are
+//  checked against the tick-based reference
+#define BENCH_RATE_EXP 0.7788007830714049
+#define BENCH_CHECK 10000
+
+//  a run records its timeline only when given --timeline=FILE, and a build
+//  with SCHED_NO_TIMELINE defined leaves out even the check for one
+#ifndef SCHED_NO_TIMELINE
+#define logEvent(engine, type, cpu, pid, start, end) \
+    do { if ((engine)->timeline != NULL) { timelineRecord((engine)->timeline, type, cpu, pid, 0, start, end); } } while (0)
+#define logRounds(engine, cpu, processes, rounds, start, end) \
+    do { if ((engine)->timeline != NULL) { timelineRecord((engine)->timeline, EVENT_ROUNDS, cpu, processes, rounds, start, end); } } while (0)
+#else
+#define logEvent(engine, type, cpu, pid, start, end) ((void)(start), (void)(end))
+#define logRounds(engine, cpu, processes, rounds, start, end) ((void)(rounds), (void)(start), (void)(end))
+#endif
+
+//  the event loops schedule() is built as: one through the policy's hooks, and
+//  one for each policy common enough to be specialised for a plain run (a
+//  table on one CPU, untraced and without a switch cost), with every hook and
+//  feature it leaves out folded away at compile time
+#define LOOP_HOOKS 0
+#define LOOP_NPP 1
+#define LOOP_RR 2
+#define LOOP_FCFS 3
+#define LOOP_SJF 4
+
+//  the engine loop and its helpers are forced inline into each variant, for
+//  the variant's constant to fold their branches
+#if defined(__GNUC__)
+#define LOOP_INLINE static inline __attribute__((always_inline))
+#else
+#define LOOP_INLINE static inline
+#endif
 
 //------------------------------------------------------------------------------
 //  Structs
 //------------------------------------------------------------------------------
-struct ProcessNode {
-    int pid, arrival, burst, finish, waiting, leftover, priority;
-    struct ProcessNode *next;
-    struct ProcessNode *prev;
+//  structure-of-arrays process table: one contiguous column per field, with
+//  every queue below referring to a process by its 32-bit row index
+struct ProcessTable {
+    int *pid;
+    int *arrival;
+    int *burst;
+    int *priority;
+    int *leftover;
+    long long *finish;
+    long long *waiting;
+    long long *started;
+    int *preemptions;
+    int *order;
+    int count;
+    int capacity;
+    void *mapping;
+    size_t mappingSize;
+    struct ProcessTable *source;
+};
+
+//  a binary trace is this header followed by the pid, arrival, burst and
+//  priority columns (count ints each, native byte order) and then the rows
+//  1..count-1 in stable arrival order, so a run can use the columns in place
+//  and skip sorting
+struct TraceHeader {
+    char magic[8];
+    int version;
+    int count;
+};
+
+//  a checkpoint is this header, naming the policy and the parameters it was
+//  created with, then the state below and then, each in native byte order:
+//  the table's rows (count of each column), the ReadyQueue, FreeRows and
+//  Inbox rings and any MLFQ levels (each a count and its items from the
+//  head), any ReadyHeap (a count, its seq and its entries), any MLFQ level of
+//  each row, and the three histograms (each the number of buckets up to the
+//  last used, those buckets, and then its count, below, min and max)
+struct CheckpointHeader {
+    char magic[8];
+    int version;
+    char policy[8];
+    int quantum;
+    int switchCost;
+    int levels;
+    int boost;
+};
+
+//  every scalar of a live engine's state, as it stands at a pause
+struct CheckpointState {
+    long long llEvents;
+    long long llWait;
+    long long llTurnover;
+    long long llSwitches;
+    long long llSwitchTime;
+    long long llEnd;
+    long long llClock;
+    long long llHorizon;
+    long long CLOCK;
+    long long llDispatch;
+    long long llStart;
+    long long llEvent;
+    long long llResponse;
+    long long llBusy;
+    long long llAdmitted;
+    long long llMaxReady;
+    long long llNextBoost;
+    long long llPromotions;
+    long long llDemotions;
+    unsigned long long mask;
+    int count;
+    int completed;
+    int pending;
+    int next[4];
+    int iUntilScan;
+    int iLatest;
+    int iCurrent;
+    int iPrevious;
+    int iRunning;
+    int iCompleting;
+};
+
+//  bump allocator that hands out a run's queues contiguously from large slabs,
+//  all of which are released together by del_arena(), or kept as spares by
+//  arenaReset() for the next run to carve from
+struct ArenaSlab {
+    struct ArenaSlab *next;
+    size_t size;
+    size_t used;
+};
+
+struct Arena {
+    struct ArenaSlab *slabs;
+    struct ArenaSlab *spare;
+};
+
+//  ring of row indices carved from an arena; queues of a loaded table are sized
+//  to it and never fill, while those of a streaming run double when they do.
+//  The capacity is always a power of two so a slot wraps with a mask
+struct IndexQueue {
+    int *items;
+    int head;
+    int count;
+    int capacity;
+    struct Arena *arena;
+};
+
+//  binary min-heap of row indices keyed on (key, seq), where seq counts
+//  admissions and so orders equal keys by arrival and then input order (FCFS)
+struct HeapEntry {
+    int index;
+    int seq;
+    long long key;
+};
+
+struct Heap {
+    struct HeapEntry *entries;
+    int count;
+    int capacity;
+    int seq;
+    struct Arena *arena;
+    //  for an indexed heap, the slot of each row index in it (-1 if absent),
+    //  so an entry can be found to change its key or take it out
+    int *position;
+    int positions;
+};
+
+//  reads a text trace a LOAD_BLOCK at a time and hands out one process per
+//  line, so that a trace never has to be held in memory all at once
+struct TraceReader {
+    FILE *file;
+    char *buffer;
+    char *line;
+    char *end;
+    int eof;
+    long lLine;
+};
+
+//  tasks shared out among worker threads, each taking the next as it frees up
+struct Tasks {
+    int count;
+    int next;
+#ifndef _WIN32
+    pthread_mutex_t lock;
+#endif
+};
+
+//  a newline-bounded piece of a text input file parsed by one thread: its
+//  processes as pid, arrival, burst and priority in turn, the lines it holds
+//  up to its first malformed one (numbered from its start), and the row of
+//  the table its first process is copied to
+struct ParseChunk {
+    const char *start;
+    const char *end;
+    int *values;
+    int count;
+    int capacity;
+    long lLines;
+    long lMalformed;
+    int iRow;
+};
+
+//  a text input file parsed in parallel a chunk per task, and then copied
+//  into the table the same way once every chunk knows its first row
+struct Parse {
+    struct Tasks tasks;
+    struct ParseChunk *chunks;
+    struct ProcessTable *table;
+    int iFilling;
+};
+
+//  a stable sort by arrival in parallel: runs iRun long are sorted a task
+//  each while iWidth is 0, and are then merged pairwise a round at a time,
+//  the output of each round cut into as many even slices as there are tasks
+struct Sort {
+    struct Tasks tasks;
+    int *arrival;
+    int *src;
+    int *dst;
+    int n;
+    int iRun;
+    int iWidth;
+};
+
+//  buffered results writer, flushed to its file in WRITE_BLOCK sized chunks
+struct Writer {
+    FILE *file;
+    char *buffer;
+    size_t used;
+    int failed;
+};
+
+//  the ready processes of an MLFQ run, one ring per level with bit l of mask
+//  set while level l has any, the level of each row, and the quantum of each
+//  level; every boost ms all of them go back to the top level
+struct Mlfq {
+    struct IndexQueue **Levels;
+    int *quantum;
+    int count;
+    unsigned long long mask;
+    int *level;
+    int rows;
+    int boost;
+    long long nextBoost;
+    long long llPromotions;
+    long long llDemotions;
+};
+
+//  one simulated CPU: the process it runs until its slice ends at until,
+//  with completing set if the process finishes then, and the ready structures
+//  it schedules from, which every CPU shares under a global queue. previous is
+//  the unfinished process whose state it still holds, -2 if that finished and
+//  -1 before it has run any. quiet is the earliest it could next finish a
+//  process while its ring keeps the same members, and drained the earliest
+//  it could run out of them (both -1 until worked out); untilScan is its own
+//  count of rrForward()'s dispatches before another scan
+struct Cpu {
+    int current;
+    int previous;
+    long long until;
+    int slice;
+    int completing;
+    struct IndexQueue *ReadyQueue;
+    struct Heap *ReadyHeap;
+    long long llBusy;
+    int steals;
+    long long quiet;
+    long long drained;
+    int untilScan;
+};
+
+//  log-linear histogram of a run's values, so that percentiles cost the same
+//  fixed memory however many processes there are; values below zero (only the
+//  first process can wait a negative time) are counted apart with their least
+struct Histogram {
+    long long counts[HISTOGRAM_BUCKETS];
+    long long count;
+    long long below;
+    long long min;
+    long long max;
 };
 
-struct List {
-    struct ProcessNode *head;
-    struct ProcessNode *tail;
+//  the distributions of a run's waiting, turnover and response times, with
+//  the time processes spent on a CPU, and the most ever ready at once
+struct Stats {
+    struct Histogram Wait;
+    struct Histogram Turnover;
+    struct Histogram Response;
+    long long llResponse;
+    long long llBusy;
+    long long llAdmitted;
+    long long llMaxReady;
+};
+
+//  one span of a run's timeline on a CPU, or an instant on none (-1) for an
+//  arrival: a slice that ran pid, the last one if it finished, a context
+//  switch away from pid (-1 if that finished), or a stretch of RR rounds
+//  resolved at once over pid processes, as many as rounds of them
+struct Event {
+    long long start;
+    int length;
+    int type;
+    int cpu;
+    int pid;
+    int rounds;
+};
+
+//  the timeline of a run, whose events fill a fixed block that is spilled to
+//  a binary log each time it fills, until the whole log is exported at once
+struct Timeline {
+    struct Event *events;
+    int used;
+    FILE *log;
+    int failed;
+};
+
+//  what a live engine has been told: the processes submitted but not yet in
+//  its lookahead, four items apiece (pid, arrival, burst and priority), the
+//  latest arrival among them, the time it may be advanced to, and who to tell
+//  of each finish. Each advance leaves where schedule() paused, in the middle
+//  of a dispatch if iRunning
+struct Live {
+    struct IndexQueue *Inbox;
+    int iLatest;
+    long long llHorizon;
+    SchedCallback callback;
+    void *context;
+    long long CLOCK;
+    int iCurrent;
+    int iPrevious;
+    int iRunning;
+    int iCompleting;
+    long long llDispatch;
+    long long llStart;
+    long long llEvent;
+};
+
+//  the handle sched.h hands out, owning everything of its engine
+struct Sched {
+    struct Arena *arena;
+    struct Engine *engine;
+    struct Live live;
+};
+
+//  one simulation run: the table and the queues its processes pass through.
+//  A streaming run fills the table from reader only as the clock reaches each
+//  arrival, and hands every finished process straight to writer, putting its
+//  row back on FreeRows for a later arrival to reuse. A live engine's arrivals
+//  come through the same lookahead from what was submitted to it, and its
+//  finished processes go to the callback instead
+struct Engine {
+    struct ProcessTable *table;
+    struct Arena *arena;
+    struct IndexQueue *JobQueue;
+    struct IndexQueue *ReadyQueue;
+    struct IndexQueue *ProcessQueue;
+    struct TraceReader *reader;
+    struct Writer *writer;
+    struct IndexQueue *FreeRows;
+    struct Live *live;
+    int iLookahead;
+    int iBinary;
+    int iLimit;
+    int iRead;
+    int pending;
+    int next[4];
+    long lMalformed;
+    long lUnsorted;
+    long lNegative;
+    int completed;
+    long long llEvents;
+    long long llWait;
+    long long llTurnover;
+    struct Stats *stats;
+    struct Timeline *timeline;
+    //  the policy being run, and the ReadyHeap of those keeping one
+    struct Policy *policy;
+    int iQuantum;
+    //  the cost of a context switch, whether one was asked for, and the
+    //  switches made and time they took
+    int iSwitch;
+    int iSwitching;
+    long long llSwitches;
+    long long llSwitchTime;
+    struct Heap *ReadyHeap;
+    //  with iCpus > 1, the CPUs, a stack of the idle ones, and the count of
+    //  processes ready on any of them; ReadyQueue and ReadyHeap are then those
+    //  of whichever CPU is being served
+    int iCpus;
+    int iGlobal;
+    struct Cpu *cpus;
+    int *Idle;
+    int iIdle;
+    int iReady;
+    int iPlace;
+    long long llEnd;
+    //  the instant of the latest arrival check, which every event passes
+    long long llClock;
+    //  the levels and boost period asked of MLFQ, and its state once running
+    int iLevels;
+    int iBoost;
+    struct Mlfq *mlfq;
+    //  scratch for rrForward(), sized to the largest ring it has seen
+    int *Members;
+    int *Tree;
+    long long *Starts;
+    int iMembers;
+    int iUntilScan;
+    struct Heap *Rounds;
+    //  with iCpus > 1, the CPU rrForward() is resolving the ring of, and the
+    //  instants it must finish processes and skip rounds short of for the sake
+    //  of the others (-1 if none)
+    int iServing;
+    long long llBarrier;
+    long long llSteal;
+};
+
+//  a scheduling policy as hooks on the shared event loop in schedule():
+//  onArrival takes each newly admitted process, selectNext picks the next to
+//  dispatch (-1 when none is ready), slice bounds how long it runs before
+//  onQuantum takes it back (NULL to run it to completion), onComplete sees it
+//  finish, preempts says at each arrival whether it must give way at once,
+//  and forward may jump the clock over events it can work out itself. Plain,
+//  where there is one, is the loop specialised for a plain run of the policy
+struct Policy {
+    char *cName;
+    int iQuantum;
+    void (*init)(struct Engine *engine);
+    void (*onArrival)(struct Engine *engine, int index);
+    int (*selectNext)(struct Engine *engine);
+    int (*slice)(struct Engine *engine, int index);
+    void (*onQuantum)(struct Engine *engine, int index);
+    void (*onComplete)(struct Engine *engine, int index);
+    int (*preempts)(struct Engine *engine, int index);
+    long long (*forward)(struct Engine *engine, int *iCurrent, long long CLOCK);
+    void (*plain)(struct Engine *engine);
+};
+
+//  one configuration of a sweep and the summary of its run
+struct SweepRun {
+    char *cAlgorithm;
+    int iQuantum;
     int count;
+    long long llWait;
+    long long llTurnover;
+    long long llSwitches;
+    long long llSwitchTime;
+    long long llEnd;
+};
+
+//  the wall time of each phase of a --profile run that ran, and where the
+//  kernel lets perf_event counters be opened (counting, or -1 where not) the
+//  cycles, cache misses and branch misses it took; started holds the readings
+//  the current phase began with
+struct Profile {
+    int counters[PROFILE_COUNTERS];
+    int iCounting;
+    long long llStarted;
+    long long started[PROFILE_COUNTERS];
+    long long wall[PROFILE_PHASES];
+    long long counts[PROFILE_PHASES][PROFILE_COUNTERS];
+    int ran[PROFILE_PHASES];
+};
+
+//  the tick-based run bench checks the engine against, sharing nothing with
+//  it but the input columns of the table: the rows by arrival and the next to
+//  arrive, each one's time left, MLFQ level and whether it is ready, the ready
+//  list in the order processes joined it, and the results. iKey says what
+//  orders the list: 0 nothing (FIFO), 1 priority, 2 burst, 3 time left, or 4
+//  MLFQ level, and iKeep whether the running process stays on it
+struct Reference {
+    int *order;
+    int next;
+    int *left;
+    int *level;
+    int *inReady;
+    int *ready;
+    int *scratch;
+    int readyCount;
+    int iKey;
+    int iKeep;
+    int iLevels;
+    long long *quantum;
+    long long boost;
+    long long nextBoost;
+    long long *finish;
+    int *preemptions;
+    int *done;
+    int completed;
+    long long llSwitches;
+};
+
+//  shared by every sweep worker, a task for each of its runs
+struct Sweep {
+    struct Tasks tasks;
+    struct ProcessTable *table;
+    struct SweepRun *runs;
+    int iSwitch;
+};
+
+//  one line of a batch manifest, with the summary of its run; iFailed is set
+//  if its input could not be loaded or its results file written
+struct BatchJob {
+    char *cInputFilepath;
+    char *cOutputFilepath;
+    int iLimit;
+    int iFailed;
+    struct SweepRun run;
+};
+
+//  shared by every batch worker, a task for each of its jobs as for a sweep's
+//  runs, along with the options every job of the batch is run with
+struct Batch {
+    struct Tasks tasks;
+    struct BatchJob *jobs;
+    int iBinary;
+    int iLevels;
+    int iBoost;
+    int iSwitch;
+    int iSwitching;
 };
 
 //------------------------------------------------------------------------------
 //  Function Prototypes
 //------------------------------------------------------------------------------
-struct ProcessNode *init_process(int pid, int arrivalTime, int burstTime, int priority);
-void del_process(struct ProcessNode *node);
-struct List *init_list();
-void del_list(struct List *list);
-void enqueue(struct List *list, struct ProcessNode *node);
-struct ProcessNode *dequeue(struct List *queue);
-void swapWithNext(struct ProcessNode *i);
-void insSortPriority(struct List *list);
-void arrivalChecker(struct List *ReadyQueue, struct List *JobQueue, int CLOCK);
-void npp(struct List *ReadyQueue, struct List *ProcessQueue);
-void rr(struct List *ReadyQueue, struct List *ProcessQueue, int iQuantum);
-struct List *processQueue(struct List *ReadyQueue, char *cAlgorithm, int iQuantum);
+struct ProcessTable *init_table();
+void del_table(struct ProcessTable *table);
+void tableReserve(struct ProcessTable *table, int capacity);
+int tableAppend(struct ProcessTable *table, int pid, int arrivalTime, int burstTime, int priority);
+void tableFill(struct ProcessTable *table, int row, int pid, int arrivalTime, int burstTime, int priority);
+struct ProcessTable *init_table_view(struct ProcessTable *source);
+int threadCount(int iThreads);
+int takeTask(struct Tasks *tasks);
+void runWorkers(void *(*worker)(void *), struct Tasks *tasks, void *shared, int iThreads);
+struct ProcessTable *importTrace(char *cFilepath, int iLimit, int iThreads, int *iStatus);
+int compareInts(const void *a, const void *b);
+int findDuplicatePid(struct ProcessTable *table, int *pid);
+int checkTable(struct ProcessTable *table, char *cFilepath, int iLimit);
+int parsePositive(const char *text);
+int parseInteger(const char *text, int *iValue);
+int parseSeed(const char *text, unsigned long long *seed);
+long loadText(char *cFilepath, FILE *file, struct ProcessTable *table, int iLimit, int iThreads);
+int parseLine(const char *line, const char *end, int *values);
+struct TraceReader *init_reader(FILE *file);
+void del_reader(struct TraceReader *reader);
+int readProcess(struct TraceReader *reader, int *values);
+long loadTrace(FILE *file, struct ProcessTable *table, int iLimit);
+void parseChunk(struct ParseChunk *chunk);
+void *parseWorker(void *arg);
+long loadTraceParallel(char *text, size_t size, struct ProcessTable *table, int iThreads);
+int isTrace(char *cFilepath);
+char *mapFile(char *cFilepath, size_t *size);
+void unmapFile(char *mapping, size_t size);
+int mapTrace(char *cFilepath, struct ProcessTable *table, int iLimit);
+int convertTrace(char *cInputFilepath, char *cTraceFilepath, int iThreads);
+struct Writer *init_writer(FILE *file);
+int del_writer(struct Writer *writer);
+void writerFlush(struct Writer *writer);
+void writeInt(struct Writer *writer, long long value);
+void writeResult(struct Writer *writer, int iBinary, int pid, int arrival, long long finish, long long waiting, int preemptions);
+void writeResultsHeader(FILE *file, int count);
+struct Arena *init_arena();
+void del_arena(struct Arena *arena);
+void arenaReset(struct Arena *arena);
+void *arenaAlloc(struct Arena *arena, size_t size);
+struct IndexQueue *init_queue(struct Arena *arena, int capacity);
+void enqueue(struct IndexQueue *queue, int index);
+int dequeue(struct IndexQueue *queue);
+void growQueue(struct IndexQueue *queue);
+struct Heap *init_heap(struct Arena *arena, int capacity);
+struct Heap *init_indexed_heap(struct Arena *arena, int capacity, int rows);
+int heapBefore(struct HeapEntry *a, struct HeapEntry *b);
+void heapPlace(struct Heap *heap, int i, struct HeapEntry entry);
+void heapSift(struct Heap *heap, int i, struct HeapEntry entry);
+void heapPush(struct Heap *heap, int index, long long key);
+int heapPop(struct Heap *heap);
+int heapHas(struct Heap *heap, int index);
+void heapUpdate(struct Heap *heap, int index, long long key);
+void heapRemove(struct Heap *heap, int index);
+struct Stats *init_stats(struct Arena *arena);
+int highestBit(unsigned long long mask);
+int histogramBucket(long long value);
+long long histogramValue(int bucket);
+void histogramRecord(struct Histogram *histogram, long long value);
+long long histogramPercentile(struct Histogram *histogram, double dPercentile);
+void printPercentiles(char *cName, struct Histogram *histogram);
+void sumTotalsScalar(const long long *finish, const long long *started, const int *arrival, const int *burst, int i, int n, long long *totals);
+#ifdef SCHED_AVX2
+int sumTotalsAvx2(const long long *finish, const long long *started, const int *arrival, const int *burst, int n, long long *totals);
+#endif
+#ifdef SCHED_NEON
+int sumTotalsNeon(const long long *finish, const long long *started, const int *arrival, const int *burst, int n, long long *totals);
+#endif
+void sumTotals(struct Engine *engine);
+struct Timeline *init_timeline();
+void del_timeline(struct Timeline *timeline);
+void timelineRecord(struct Timeline *timeline, int type, int cpu, int pid, int rounds, long long start, long long end);
+void timelineSpill(struct Timeline *timeline);
+void writeText(struct Writer *writer, const char *text);
+void writeEvent(struct Writer *writer, struct Event *event, int iCpus);
+int exportTimeline(struct Timeline *timeline, FILE *file, int iCpus);
+int sortedPrefixScalar(const int *values, int i, int n);
+#ifdef SCHED_AVX2
+int sortedPrefixAvx2(const int *values, int n);
+#endif
+#ifdef SCHED_NEON
+int sortedPrefixNeon(const int *values, int n);
+#endif
+int sortedPrefix(const int *values, int n);
+void mergeRuns(const int *arrival, const int *a, int na, const int *b, int nb, int *out);
+int *sortRun(const int *arrival, int *src, int *dst, int n);
+int mergeSplit(const int *arrival, const int *a, int na, const int *b, int nb, int k);
+void *sortWorker(void *arg);
+void sortArrival(struct ProcessTable *table, struct Arena *arena, struct IndexQueue *queue, int iThreads);
+struct IndexQueue *init_job_queue(struct ProcessTable *table, struct Arena *arena, int iThreads);
+struct Engine *init_engine(struct ProcessTable *table, struct Arena *arena);
+struct Engine *init_stream(struct Arena *arena, struct TraceReader *reader, struct Writer *writer, int iBinary, int iLimit);
+void readAhead(struct Engine *engine);
+int admitStreamed(struct Engine *engine);
+int firstProcess(struct Engine *engine);
+void finishProcess(struct Engine *engine, int index, long long CLOCK);
+void startProcess(struct Engine *engine, int index, long long CLOCK);
+void admitReady(struct Engine *engine, int index);
+void arrivalChecker(struct Engine *engine, long long CLOCK);
+long long nextArrival(struct Engine *engine, long long CLOCK);
+long long contextSwitch(struct Engine *engine, int previous, long long CLOCK);
+LOOP_INLINE long long tableNextArrival(struct Engine *engine, long long CLOCK);
+LOOP_INLINE void loopAdmit(struct Engine *engine, const int iLoop, int index);
+LOOP_INLINE void loopArrivals(struct Engine *engine, const int iLoop, long long CLOCK);
+LOOP_INLINE long long loopNextArrival(struct Engine *engine, const int iLoop, long long CLOCK);
+LOOP_INLINE int loopSelect(struct Engine *engine, const int iLoop);
+LOOP_INLINE void scheduleLoop(struct Engine *engine, const int iLoop);
+void schedule(struct Engine *engine);
+void scheduleNpp(struct Engine *engine);
+void scheduleRr(struct Engine *engine);
+void scheduleFcfs(struct Engine *engine);
+void scheduleSjf(struct Engine *engine);
+int processQueue(struct Engine *engine, char *cAlgorithm, int iQuantum);
+void init_cpus(struct Engine *engine);
+void serveCpu(struct Engine *engine, struct Cpu *cpu);
+int takeReady(struct Engine *engine, struct Cpu *cpu);
+void quietUntil(struct Engine *engine, struct Cpu *cpu);
+int forwardBarrier(struct Engine *engine, struct Cpu *cpu, long long CLOCK);
+void dispatchCpu(struct Engine *engine, struct Cpu *cpu, int index, long long CLOCK, struct Heap *Events);
+void dispatchIdle(struct Engine *engine, struct Heap *Events, long long CLOCK);
+void scheduleSMP(struct Engine *engine);
+void fifoArrival(struct Engine *engine, int index);
+int fifoSelect(struct Engine *engine);
+void heapInit(struct Engine *engine);
+int heapSelect(struct Engine *engine);
+void priorityArrival(struct Engine *engine, int index);
+void burstArrival(struct Engine *engine, int index);
+int rrSlice(struct Engine *engine, int index);
+void indexedInit(struct Engine *engine);
+int heapFront(struct Engine *engine);
+void indexedComplete(struct Engine *engine, int index);
+void leftoverArrival(struct Engine *engine, int index);
+int priorityPreempts(struct Engine *engine, int index);
+int leftoverPreempts(struct Engine *engine, int index);
+int lowestBit(unsigned long long mask);
+void mlfqInit(struct Engine *engine);
+void mlfqQueue(struct Engine *engine, int index);
+void mlfqArrival(struct Engine *engine, int index);
+int mlfqSelect(struct Engine *engine);
+int mlfqSlice(struct Engine *engine, int index);
+void mlfqQuantum(struct Engine *engine, int index);
+int mlfqPreempts(struct Engine *engine, int index);
+int fenwickSum(int *tree, int i);
+void fenwickAdd(int *tree, int n, int i, int delta);
+long long rrForward(struct Engine *engine, int *iCurrent, long long CLOCK);
+struct Policy *findPolicy(char *cAlgorithm);
+void *sweepWorker(void *arg);
+int sweep(char *cInputFilepath, char *cSummaryFilepath, int iFirst, int iLast, int iThreads, int iSwitch);
+int batchRun(struct Batch *batch, struct BatchJob *job, struct Arena *arena);
+void *batchWorker(void *arg);
+int readManifest(char *cManifestFilepath, struct Batch *batch, char **cText);
+int batch(char *cManifestFilepath, char *cSummaryFilepath, int iThreads, int iBinary, int iLevels, int iBoost, int iSwitch, int iSwitching);
+long long nowNanoseconds();
+struct Profile *init_profile();
+void del_profile(struct Profile *profile);
+void profileRead(struct Profile *profile, long long *values);
+void profileStart(struct Profile *profile);
+void profileStop(struct Profile *profile, int phase);
+void printProfile(struct Profile *profile, int iStream);
+unsigned long long benchRandom(unsigned long long *state);
+void generateTrace(FILE *file, int iCount, unsigned long long seed);
+int generate(int iCount, char *cFilepath, unsigned long long seed);
+long benchPeakKilobytes();
+long long referenceKey(struct ProcessTable *table, struct Reference *reference, int index);
+void referencePush(struct Reference *reference, int index);
+void referenceRemove(struct Reference *reference, int iPosition);
+int referenceBest(struct ProcessTable *table, struct Reference *reference);
+int referenceAdmit(struct ProcessTable *table, struct Reference *reference, long long t);
+int referenceSelect(struct ProcessTable *table, struct Reference *reference, long long t);
+int referenceOutranked(struct ProcessTable *table, struct Reference *reference, int index);
+void referenceFinish(struct Reference *reference, int index, long long t);
+struct Reference *init_reference(struct ProcessTable *table, char *cAlgorithm, int iQuantum, int iSwitch, int iLevels, int iBoost);
+void del_reference(struct Reference *reference);
+int referenceCompare(struct Engine *engine, struct Reference *reference);
+int bench(int iFirst, int iLast, int iQuantum, unsigned long long seed, int iSwitch, int iSwitching, int iLevels, int iBoost);
+void checkpointQueue(FILE *file, struct IndexQueue *queue);
+int restoreQueue(FILE *file, struct IndexQueue *queue, int iRows);
+void checkpointHistogram(FILE *file, struct Histogram *histogram);
+int restoreHistogram(FILE *file, struct Histogram *histogram);
+int restoreState(FILE *file, struct Sched *sched, struct CheckpointState *state);
+int abandonRun(FILE *file, struct TraceReader *reader, struct ProcessTable *table, FILE *output, struct Writer *writer,
+    FILE *timelineFile, struct Timeline *timeline, struct Arena *arena, struct Profile *profile, int iStatus);
+//  and the library's, sched_create() to sched_restore(), in sched.h
 
 
+//  a build with SCHED_NO_MAIN defined leaves main() out, to be linked into
+//  another program through sched.h
+#ifndef SCHED_NO_MAIN
+//  frees whatever a run has taken so far, any of it NULL if not yet taken,
+//  when it has to stop early; returns iStatus, the exit status to stop with
+int abandonRun(FILE *file, struct TraceReader *reader, struct ProcessTable *table, FILE *output, struct Writer *writer,
+    FILE *timelineFile, struct Timeline *timeline, struct Arena *arena, struct Profile *profile, int iStatus) {
+    if (writer != NULL) { del_writer(writer); }
+    if (output != NULL) { fclose(output); }
+    if (timeline != NULL) { del_timeline(timeline); }
+    if (timelineFile != NULL) { fclose(timelineFile); }
+    if (reader != NULL) { del_reader(reader); }
+    if (file != NULL) { fclose(file); }
+    if (arena != NULL) { del_arena(arena); }
+    if (table != NULL) { del_table(table); }
+    if (profile != NULL) { del_profile(profile); }
+    return iStatus;
+}
+
 int main(int argc, char *argv[]) {
-    char cInputFilepath[256];
-    char cOutputFilepath[256];
-    char cAlgorithm[256];
+    char *cInputFilepath;
+    char *cOutputFilepath;
+    char *cAlgorithm;
     int iQuantum = 0;
     int iLimit = 0;
+    int iBinary = 0;
+    int iStream = 0;
+    int iThreads = 0;
+    int iCpus = 1;
+    int iGlobal = 0;
+    int iLevels = 0;
+    int iBoost = 0;
+    int iSwitch = 0;
+    int iSwitching = 0;
+    int iProfile = 0;
+    int iPause = 1;
+    int iStatus;
+    char *cTimelineFilepath = NULL;
+    unsigned long long seed = 1;
+    struct Profile *profile = NULL;
+
+    //  take --options out, leaving only the positional arguments in argv
+    int iArgs = 1;
+    for (int i = 1;i < argc;i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            argv[iArgs++] = argv[i];
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            iBinary = 1;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            iStream = 1;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            iThreads = parsePositive(argv[i] + 10);
+            if (iThreads == -1) {
+                printf("Sorry, but the number of --threads must be a positive integer, not %s.\n", argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--cpus=", 7) == 0) {
+            iCpus = parsePositive(argv[i] + 7);
+            if (iCpus == -1) {
+                printf("Sorry, but there must be a positive integer number of CPUs to schedule on, not %s.\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--global") == 0) {
+            iGlobal = 1;
+        } else if (strncmp(argv[i], "--levels=", 9) == 0) {
+            iLevels = parsePositive(argv[i] + 9);
+            if (iLevels < 1 || iLevels > 64) {
+                printf("Sorry, but MLFQ can only have from 1 to 64 levels.\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--boost=", 8) == 0) {
+            if (parseInteger(argv[i] + 8, &iBoost) != 0) {
+                printf("Sorry, but the --boost period must be an integer number of milliseconds, not %s.\n", argv[i] + 8);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--switch=", 9) == 0) {
+            iSwitching = 1;
+            if (parseInteger(argv[i] + 9, &iSwitch) != 0 || iSwitch < 0) {
+                printf("Sorry, but a context switch must take a non-negative integer number of milliseconds, not %s.\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            iProfile = 1;
+        } else if (strcmp(argv[i], "--no-pause") == 0) {
+            iPause = 0;
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            if (parseSeed(argv[i] + 7, &seed) != 0) {
+                printf("Sorry, but the --seed must be a non-negative integer, not %s.\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--timeline=", 11) == 0) {
+#ifdef SCHED_NO_TIMELINE
+            printf("Sorry, but this build of the program was made without timelines.\n");
+            return 1;
+#else
+            cTimelineFilepath = argv[i] + 11;
+#endif
+        } else {
+            printf("Sorry, but %s is not an option this program recognises.\n", argv[i]);
+            return 1;
+        }
+    }
+    argc = iArgs;
+
+    //  conversion of a text input file into a binary trace
+    if (argc == 4 && strcmp(argv[1], "convert") == 0) {
+        return convertTrace(argv[2], argv[3], iThreads);
+    }
+    //  parallel sweep over quanta
+    if (argc == 6 && strcmp(argv[1], "sweep") == 0) {
+        return sweep(argv[2], argv[3], parsePositive(argv[4]), parsePositive(argv[5]), iThreads, iSwitch);
+    }
+    //  many runs in one process, listed in a manifest
+    if (argc == 4 && strcmp(argv[1], "batch") == 0) {
+        return batch(argv[2], argv[3], iThreads, iBinary, iLevels, iBoost, iSwitch, iSwitching);
+    }
+    //  synthetic traces, and the benchmark run on them
+    if (argc == 4 && strcmp(argv[1], "generate") == 0) {
+        return generate(parsePositive(argv[2]), argv[3], seed);
+    }
+    if (argc >= 2 && argc <= 5 && strcmp(argv[1], "bench") == 0) {
+        return bench((argc > 2) ? parsePositive(argv[2]) : 1000, (argc > 3) ? parsePositive(argv[3]) : 1000000, (argc > 4) ? parsePositive(argv[4]) : 4,
+            seed, iSwitch, iSwitching, iLevels, iBoost);
+    }
 
     //  handle command line args:
     if (argc < 4 || argc>6) {
         printf("Sorry, but something's not quite right about your invocation.");
         return 1;
     }
-    if (argc >= 4 && argc <= 6) {
-        strcpy(cInputFilepath, argv[1]);
-        strcpy(cOutputFilepath, argv[2]);
-        strcpy(cAlgorithm, argv[3]);
+    cInputFilepath = argv[1];
+    cOutputFilepath = argv[2];
+    cAlgorithm = argv[3];
+    struct Policy *policy = findPolicy(cAlgorithm);
+    if (policy == NULL) {
+        printf("Sorry, but %s is not an algorithm this program can simulate.\n", cAlgorithm);
+        return 1;
     }
-    if (strcmp(cAlgorithm, "NPP") == 0 && argc == 5) {
-        iLimit = atoi(argv[4]);
-    } else if (strcmp(cAlgorithm, "RR") == 0 && argc == 4) {
-        printf("Sorry, but simulating RR requires you specify a positive integer [quantum] value representing the length of the time quantum (time slice).\nPerhaps try the following invocation: ./sched in.txt out.txt RR 4\n");
+    if (iCpus > 1 && policy->preempts != NULL) {
+        printf("Sorry, but %s can only be simulated on a single CPU.\n", cAlgorithm);
         return 1;
-    } else if (strcmp(cAlgorithm, "RR") == 0 && argc == 5) {
-        iQuantum = atoi(argv[4]);
-    } else if (strcmp(cAlgorithm, "RR") == 0 && argc == 6) {
-        iQuantum = atoi(argv[4]);
-        iLimit = atoi(argv[5]);
     }
-
-    //  opening the input file for process import
-    FILE *file;
-    file = fopen(cInputFilepath, "r");
-    if (file == NULL) {
-        printf("Sorry, but there seems to be no such file at %s.\n", cInputFilepath);
+    //  a quantum of 0 would never let the clock move, so both it and the
+    //  limit must be positive integers
+    if (policy->iQuantum && (argc == 4 || (iQuantum = parsePositive(argv[4])) == -1)) {
+        printf("Sorry, but simulating %s requires you specify a positive integer [quantum] value representing the length of the time quantum (time slice).\nPerhaps try the following invocation: ./sched in.txt out.txt %s 4\n", cAlgorithm, cAlgorithm);
+        return FAIL_QUANTUM;
+    }
+    if (argc > (policy->iQuantum ? 6 : 5)) {
+        printf("Sorry, but %s takes no [quantum], so only a [limit] may follow it.\n", cAlgorithm);
         return 1;
     }
+    if (argc == (policy->iQuantum ? 6 : 5) && (iLimit = parsePositive(argv[argc - 1])) == -1) {
+        printf("Sorry, but the [limit] must be a positive integer, not %s.\n", argv[argc - 1]);
+        return 1;
+    }
+    profile = iProfile ? init_profile() : NULL;
 
-    //  process importation
-    struct List *ReadyQueue = init_list();
-    struct ProcessNode *currentProcess;
-    int iPid;
-    int iArrivalTime;
-    int iBurstTime;
-    int iPriority;
-    //  handle limit first
-    if (iLimit > 0) {
-        for (int i = 0;i < iLimit;i++) {
-            fscanf(file, "%d %d %d %d", &iPid, &iArrivalTime, &iBurstTime, &iPriority);
-            currentProcess = init_process(iPid, iArrivalTime, iBurstTime, iPriority);
-            currentProcess->leftover = currentProcess->burst;
-            enqueue(ReadyQueue, currentProcess);
+    //  process importation, up front unless streaming
+    FILE *file = NULL;
+    struct ProcessTable *ProcessTable = NULL;
+    struct TraceReader *reader = NULL;
+    if (iStream) {
+        if (isTrace(cInputFilepath)) {
+            printf("Sorry, but only text input files can be streamed.\n");
+            return abandonRun(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, profile, 1);
         }
+        file = fopen(cInputFilepath, "r");
+        if (file == NULL) {
+            printf("Sorry, but there seems to be no such file at %s.\n", cInputFilepath);
+            return abandonRun(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, profile, 1);
+        }
+        reader = init_reader(file);
     } else {
-        //  otherwise, scan until eof
-        while (fscanf(file, "%d %d %d %d", &iPid, &iArrivalTime, &iBurstTime, &iPriority) == 4) {
-            currentProcess = init_process(iPid, iArrivalTime, iBurstTime, iPriority);
-            currentProcess->leftover = currentProcess->burst;
-            enqueue(ReadyQueue, currentProcess);
+        profileStart(profile);
+        ProcessTable = importTrace(cInputFilepath, iLimit, iThreads, &iStatus);
+        profileStop(profile, PROFILE_PARSE);
+        if (ProcessTable == NULL) {
+            return abandonRun(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, profile, iStatus);
         }
     }
-    fclose(file);
-
-    //  creating and organising the final queue for printing
-    struct List *ProcessQueue;
-    ProcessQueue = processQueue(ReadyQueue, cAlgorithm, iQuantum);
 
     //  opens output file for process export
-    file = fopen(cOutputFilepath, "w");
-    if (file == NULL) {
+    FILE *output = fopen(cOutputFilepath, iBinary ? "wb" : "w");
+    if (output == NULL) {
         printf("Sorry, but the file %s could not be created.\n", cOutputFilepath);
-        return 1;
+        return abandonRun(file, reader, ProcessTable, NULL, NULL, NULL, NULL, NULL, profile, 1);
+    }
+    struct Writer *writer = init_writer(output);
+    FILE *timelineFile = NULL;
+    struct Timeline *timeline = NULL;
+    if (cTimelineFilepath != NULL) {
+        timelineFile = fopen(cTimelineFilepath, "w");
+        if (timelineFile == NULL) {
+            printf("Sorry, but the file %s could not be created.\n", cTimelineFilepath);
+            return abandonRun(file, reader, ProcessTable, output, writer, NULL, NULL, NULL, profile, 1);
+        }
+        timeline = init_timeline();
+        if (timeline == NULL) {
+            return abandonRun(file, reader, ProcessTable, output, writer, timelineFile, NULL, NULL, profile, 1);
+        }
+    }
+
+    //  creating and organising the final queue for printing
+    struct Arena *QueueArena = init_arena();
+    struct Engine *engine;
+    int iFailed;
+    if (iStream) {
+        //  the count is only known at the end, once every process is written
+        if (iBinary) { writeResultsHeader(output, 0); }
+        engine = init_stream(QueueArena, reader, writer, iBinary, iLimit);
+    } else {
+        //  sorted here rather than in init_engine() so it is timed on its own,
+        //  unless the trace stores the order
+        if (ProcessTable->order == NULL) {
+            profileStart(profile);
+            ProcessTable->order = init_job_queue(ProcessTable, QueueArena, iThreads)->items;
+            profileStop(profile, PROFILE_SORT);
+        }
+        engine = init_engine(ProcessTable, QueueArena);
+    }
+    engine->iCpus = iCpus;
+    engine->iGlobal = iGlobal;
+    engine->iLevels = iLevels;
+    engine->iBoost = iBoost;
+    engine->iSwitch = iSwitch;
+    engine->iSwitching = iSwitching;
+    engine->timeline = timeline;
+    profileStart(profile);
+    processQueue(engine, cAlgorithm, iQuantum);
+    profileStop(profile, PROFILE_SIMULATE);
+    profileStart(profile);
+    if (timeline != NULL) {
+        iFailed = exportTimeline(timeline, timelineFile, iCpus);
+        del_timeline(timeline);
+        if (fclose(timelineFile) != 0 || iFailed != 0) {
+            printf("Sorry, but the file %s could not be written.\n", cTimelineFilepath);
+            return abandonRun(file, reader, engine->table, output, writer, NULL, NULL, QueueArena, profile, 1);
+        }
+        timelineFile = NULL;
     }
 
     //  queue printing
-    int iAvgWait = 0;
-    int iAvgTO = 0;
-    int iNoProcesses = ProcessQueue->count;
-    struct ProcessNode *processDeleter;
-    for (int i = ProcessQueue->count;i > 0;i--) {
-        currentProcess = dequeue(ProcessQueue);
-        fprintf(file, "%d %d %d %d\n", currentProcess->pid, currentProcess->arrival, currentProcess->finish, currentProcess->waiting);
-        iAvgWait += currentProcess->waiting;
-        iAvgTO += currentProcess->finish - currentProcess->arrival;
-        processDeleter = currentProcess;
-        currentProcess = currentProcess->next;
-        del_process(processDeleter);
+    int iNoProcesses = engine->completed;
+    int iIndex;
+    if (!iStream) {
+        if (iBinary) { writeResultsHeader(output, iNoProcesses); }
+        while ((iIndex = dequeue(engine->ProcessQueue)) != -1) {
+            writeResult(writer, iBinary, ProcessTable->pid[iIndex], ProcessTable->arrival[iIndex], ProcessTable->finish[iIndex], ProcessTable->waiting[iIndex],
+                iSwitching ? ProcessTable->preemptions[iIndex] : -1);
+        }
     }
-    fclose(file);
-    file = NULL;
-    del_list(ProcessQueue);
+    iFailed = del_writer(writer);
+    if (iStream && iBinary && iFailed == 0) {
+        if (fseek(output, 0, SEEK_SET) == 0) {
+            writeResultsHeader(output, iNoProcesses);
+        }
+    }
+    if (fclose(output) != 0 || iFailed != 0) {
+        printf("Sorry, but the file %s could not be written.\n", cOutputFilepath);
+        return abandonRun(file, reader, engine->table, NULL, NULL, NULL, NULL, QueueArena, profile, 1);
+    }
+    output = NULL;
+    profileStop(profile, PROFILE_EXPORT);
+    if (iStream) {
+        //  the run ends at the first idle moment, but the results only match a
+        //  whole-table run if the rest of the input is in order too
+        while (engine->pending) {
+            readAhead(engine);
+        }
+        fclose(file);
+        file = NULL;
+        del_reader(reader);
+        reader = NULL;
+        ProcessTable = engine->table;
+        //  a stream is only checked as it is read, so after the run, and
+        //  without the memory to look for a pid given twice
+        iStatus = 0;
+        if (engine->lMalformed > 0) {
+            printf("Sorry, but line %ld of %s is not of the form <pid> <arrival-time> <burst-time> <priority>.\n", engine->lMalformed, cInputFilepath);
+            iStatus = FAIL_MALFORMED;
+        } else if (engine->lNegative > 0) {
+            printf("Sorry, but line %ld of %s gives a negative burst time.\n", engine->lNegative, cInputFilepath);
+            iStatus = FAIL_NEGATIVE;
+        } else if (engine->lUnsorted > 0) {
+            printf("Sorry, but streaming needs the input sorted by arrival, and line %ld of %s arrives before the line above it.\n", engine->lUnsorted, cInputFilepath);
+            iStatus = FAIL_UNSORTED;
+        } else if (engine->iRead == 0) {
+            printf("Sorry, but %s holds no processes.\n", cInputFilepath);
+            iStatus = FAIL_EMPTY;
+        } else if (iLimit > 0 && engine->iRead < iLimit) {
+            printf("Sorry, but %s holds only %d processes, fewer than the %d asked for.\n", cInputFilepath, engine->iRead, iLimit);
+            iStatus = FAIL_SHORT;
+        }
+        //  a results file written from an input that fails them is not kept
+        if (iStatus != 0) {
+            remove(cOutputFilepath);
+            return abandonRun(NULL, NULL, ProcessTable, NULL, NULL, NULL, NULL, QueueArena, profile, iStatus);
+        }
+    }
+
+    //  the totals are exact, and only the averages are rounded, to hundredths
+    double dAvgWait = (double)engine->llWait / iNoProcesses;
+    double dAvgTO = (double)engine->llTurnover / iNoProcesses;
+    printf("The average wait time was %.2f, and the average turnover time %.2f.\n", dAvgWait, dAvgTO);
+    struct Stats *stats = engine->stats;
+    long long llCapacity = (long long)iCpus * engine->llEnd;
+    printPercentiles("wait", &stats->Wait);
+    printPercentiles("turnover", &stats->Turnover);
+    printPercentiles("response", &stats->Response);
+    printf("The average response time was %.2f, and %.4f processes finished per ms.\n", (double)stats->llResponse / iNoProcesses,
+        (engine->llEnd > 0) ? (double)iNoProcesses / (double)engine->llEnd : 0.0);
+    printf("%s idle for %lld of %lld ms, and at most %lld processes were ready at once.\n", (iCpus > 1) ? "The CPUs were" : "The CPU was",
+        llCapacity - stats->llBusy - engine->llSwitchTime, llCapacity, stats->llMaxReady);
+    //  CPUs sharing one --global queue have nothing to steal from each other
+    for (int i = 0;engine->cpus != NULL && i < iCpus;i++) {
+        printf("CPU %d was busy for %lld of %lld ms (%d%%)", i, engine->cpus[i].llBusy, engine->llEnd,
+            (engine->llEnd > 0) ? (int)(engine->cpus[i].llBusy * 100 / engine->llEnd) : 0);
+        if (iGlobal) {
+            printf(".\n");
+        } else {
+            printf(", and stole %d processes.\n", engine->cpus[i].steals);
+        }
+    }
+    if (iSwitching) {
+        printf("The CPU switched between processes %lld times, spending %lld ms doing so.\n", engine->llSwitches, engine->llSwitchTime);
+    }
+    if (engine->mlfq != NULL) {
+        printf("MLFQ demoted a process %lld times, and boosted one back to the top %lld times.\n", engine->mlfq->llDemotions, engine->mlfq->llPromotions);
+    }
+    if (profile != NULL) {
+        printProfile(profile, iStream);
+        del_profile(profile);
+    }
+    //  every queue of the run goes back in one call
+    del_arena(QueueArena);
+    del_table(ProcessTable);
 
-    iAvgWait /= iNoProcesses;
-    iAvgTO /= iNoProcesses;
-    printf("The average wait time was %d, and the average turnover time %d.\n", iAvgWait, iAvgTO);
+    //  obtain user confirmation before exiting, unless told not to with
+    //  --no-pause, or run without a terminal to confirm from as in a script
+#ifndef _WIN32
+    if (!isatty(STDIN_FILENO)) {
+        iPause = 0;
+    }
+#endif
+    if (iPause) {
+        fflush(stdout);
+        getchar();
+    }
 
     //  stop Valgrind's "FILE DESCRIPTORS open at exit" error:
     fclose(stdin);
     fclose(stdout);
     fclose(stderr);
-
-    //  obtain user confirmation before exiting
-    getchar();
     return 0;
 
 } //    end main
+#endif
 
 
 //------------------------------------------------------------------------------
-//  Function Definitions: Process Methods
+//  Function Definitions: Process Table Methods
 //------------------------------------------------------------------------------
-struct ProcessNode *init_process(int pid, int arrivalTime, int burstTime, int priority) {
-    struct ProcessNode *newProcess = malloc(sizeof(struct ProcessNode));
-    if (newProcess == NULL) {
-        printf("Sorry, but memory was found to be unallocatable for the process.");
+struct ProcessTable *init_table() {
+    struct ProcessTable *newTable = malloc(sizeof(struct ProcessTable));
+    if (newTable == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the process table.");
+        exit(-1);
+    }
+    newTable->pid = NULL;
+    newTable->arrival = NULL;
+    newTable->burst = NULL;
+    newTable->priority = NULL;
+    newTable->leftover = NULL;
+    newTable->finish = NULL;
+    newTable->waiting = NULL;
+    newTable->started = NULL;
+    newTable->preemptions = NULL;
+    newTable->order = NULL;
+    newTable->count = 0;
+    newTable->capacity = 0;
+    newTable->mapping = NULL;
+    newTable->mappingSize = 0;
+    newTable->source = NULL;
+    return newTable;
+}
+
+//  a table that shares the input columns of source read-only, but has its own
+//  leftover, finish, waiting, started and preemptions columns so that runs can
+//  proceed side by side
+struct ProcessTable *init_table_view(struct ProcessTable *source) {
+    struct ProcessTable *newTable = init_table();
+    newTable->pid = source->pid;
+    newTable->arrival = source->arrival;
+    newTable->burst = source->burst;
+    newTable->priority = source->priority;
+    newTable->order = source->order;
+    newTable->count = source->count;
+    newTable->capacity = source->count;
+    newTable->source = source;
+    newTable->leftover = malloc(((size_t)source->count + 1) * sizeof(int));
+    newTable->finish = calloc((size_t)source->count + 1, sizeof(long long));
+    newTable->waiting = calloc((size_t)source->count + 1, sizeof(long long));
+    newTable->started = malloc(((size_t)source->count + 1) * sizeof(long long));
+    newTable->preemptions = calloc((size_t)source->count + 1, sizeof(int));
+    if (newTable->leftover == NULL || newTable->finish == NULL || newTable->waiting == NULL || newTable->started == NULL || newTable->preemptions == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the process table.");
         exit(-1);
     }
-    newProcess->pid = pid;
-    newProcess->arrival = arrivalTime;
-    newProcess->burst = burstTime;
-    newProcess->priority = priority;
+    memcpy(newTable->leftover, source->burst, (size_t)source->count * sizeof(int));
+    //  every byte set makes every process -1, not yet started
+    memset(newTable->started, 0xff, ((size_t)source->count + 1) * sizeof(long long));
+    return newTable;
+}
 
-    newProcess->finish = 0;
-    newProcess->waiting = 0;
-    newProcess->leftover = 0;
+void del_table(struct ProcessTable *table) {
+    //  the input columns of a view belong to its source, and those of a mapped
+    //  trace to the mapping
+    if (table->source != NULL) {
+        table->source = NULL;
+    } else if (table->mapping != NULL) {
+        unmapFile(table->mapping, table->mappingSize);
+    } else {
+        free(table->pid);
+        free(table->arrival);
+        free(table->burst);
+        free(table->priority);
+    }
+    free(table->leftover);
+    free(table->finish);
+    free(table->waiting);
+    free(table->started);
+    free(table->preemptions);
+    free(table);
+    table = NULL;
+}
 
-    newProcess->next = NULL;
-    newProcess->prev = NULL;
+//  grows every column to hold capacity rows
+void tableReserve(struct ProcessTable *table, int capacity) {
+    table->capacity = capacity;
+    table->pid = realloc(table->pid, table->capacity * sizeof(int));
+    table->arrival = realloc(table->arrival, table->capacity * sizeof(int));
+    table->burst = realloc(table->burst, table->capacity * sizeof(int));
+    table->priority = realloc(table->priority, table->capacity * sizeof(int));
+    table->leftover = realloc(table->leftover, table->capacity * sizeof(int));
+    table->finish = realloc(table->finish, table->capacity * sizeof(long long));
+    table->waiting = realloc(table->waiting, table->capacity * sizeof(long long));
+    table->started = realloc(table->started, table->capacity * sizeof(long long));
+    table->preemptions = realloc(table->preemptions, table->capacity * sizeof(int));
+    if (table->pid == NULL || table->arrival == NULL || table->burst == NULL || table->priority == NULL
+        || table->leftover == NULL || table->finish == NULL || table->waiting == NULL || table->started == NULL
+        || table->preemptions == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the process table.");
+        exit(-1);
+    }
+}
 
-    return newProcess;
+//  appends a process as a new row, doubling every column when the table fills
+int tableAppend(struct ProcessTable *table, int pid, int arrivalTime, int burstTime, int priority) {
+    int iRow;
+    if (table->count == table->capacity) {
+        tableReserve(table, (table->capacity == 0) ? 1024 : table->capacity * 2);
+    }
+    iRow = table->count++;
+    tableFill(table, iRow, pid, arrivalTime, burstTime, priority);
+    return iRow;
 }
 
-void del_process(struct ProcessNode *node) {
-    node->next = NULL;
-    node->prev = NULL;
-    free(node);
-    node = NULL;
+//  (re)initialises row as a process yet to run
+void tableFill(struct ProcessTable *table, int row, int pid, int arrivalTime, int burstTime, int priority) {
+    table->pid[row] = pid;
+    table->arrival[row] = arrivalTime;
+    table->burst[row] = burstTime;
+    table->priority[row] = priority;
+
+    table->leftover[row] = burstTime;
+    table->finish[row] = 0;
+    table->waiting[row] = 0;
+    table->started[row] = -1;
+    table->preemptions[row] = 0;
 }
 
 //------------------------------------------------------------------------------
-//  List/Queuing Methods
+//  Worker Methods
 //------------------------------------------------------------------------------
-struct List *init_list() {
-    struct List *newList = malloc(sizeof(struct List));
-    if (newList == NULL) {
-        printf("Sorry, but memory was found to be unallocatable for the list.");
-        exit(-1);
+//  the threads to run on for --threads=iThreads, all cores when not given
+int threadCount(int iThreads) {
+#ifndef _WIN32
+    if (iThreads <= 0) {
+        iThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
     }
-    newList->head = NULL;
-    newList->tail = NULL;
-    newList->count = 0;
-    return newList;
-}
-
-void del_list(struct List *list) {
-    // while (list->head != NULL && list->tail != NULL) {
-    //     struct Node *ptr = list->tail;
-    //     del_process(list, ptr);
-    // }
-    list->head = NULL;
-    list->tail = NULL;
-    free(list);
-    list = NULL;
-}
-
-void enqueue(struct List *list, struct ProcessNode *node) {
-    //  If new list
-    if (list->head == NULL && list->tail == NULL) {
-        list->head = node;
-        list->tail = node;
-        node->next = NULL;
-        node->prev = NULL;
-    } else {
-        //  If filled list
-        list->tail->next = node;
-        node->prev = list->tail;
-        node->next = NULL;
-        list->tail = node;
-    }
-    list->count++;
-}
-
-struct ProcessNode *dequeue(struct List *queue) {
-    if (queue->head == queue->tail) {
-        //  for the final item in a queue
-        struct ProcessNode *final = queue->head;
-        queue->head = NULL;
-        queue->tail = NULL;
-        queue->count--;
-        return final;
-    } else {
-        //  normal use
-        struct ProcessNode *first;
-        first = queue->head;
-        first->next->prev = NULL;
-        queue->head = first->next;
-        first->next = NULL;
-        queue->count--;
-        return first;
-    }
-}
-
-//    swap preserving next/prev pointers
-void swapWithNext(struct ProcessNode *i) {
-    struct ProcessNode *tmp = init_process(0, 0, 0, 0);
-
-    //    i -> tmp
-    tmp->pid = i->pid;
-    tmp->arrival = i->arrival;
-    tmp->burst = i->burst;
-    tmp->priority = i->priority;
-    tmp->finish = i->finish;
-    tmp->waiting = i->waiting;
-    tmp->leftover = i->leftover;
-
-    //    i->next -> i
-    i->pid = i->next->pid;
-    i->arrival = i->next->arrival;
-    i->burst = i->next->burst;
-    i->priority = i->next->priority;
-    i->finish = i->next->finish;
-    i->waiting = i->next->waiting;
-    i->leftover = i->next->leftover;
-
-    //    tmp -> i->next
-    i->next->pid = tmp->pid;
-    i->next->arrival = tmp->arrival;
-    i->next->burst = tmp->burst;
-    i->next->priority = tmp->priority;
-    i->next->finish = tmp->finish;
-    i->next->waiting = tmp->waiting;
-    i->next->leftover = tmp->leftover;
-
-    del_process(tmp);
-}
-
-//    insertion sort by priority:
-void insSortPriority(struct List *list) {
-    struct ProcessNode *ptr;
-    struct ProcessNode *i;
-    ptr = list->head;
-    i = list->head;
-
-    if (list->count == 1) { return; }
-
-    do {
-        ptr = ptr->next;
-        //    ptr is in the right place
-        if (ptr->priority >= i->priority) {
-            i = i->next;
-            continue;
+    return (iThreads < 1) ? 1 : iThreads;
+#else
+    (void)iThreads;
+    return 1;
+#endif
+}
+
+//  the next task for a worker, or -1 once they are all taken
+int takeTask(struct Tasks *tasks) {
+    int iTask;
+#ifndef _WIN32
+    pthread_mutex_lock(&tasks->lock);
+#endif
+    iTask = (tasks->next < tasks->count) ? tasks->next++ : -1;
+#ifndef _WIN32
+    pthread_mutex_unlock(&tasks->lock);
+#endif
+    return iTask;
+}
 
-        } else if (ptr->priority < i->priority) {
-            //    	ptr less than i
-            while (i != NULL && i->priority > i->next->priority) {
-                swapWithNext(i);
-                i = i->prev;
+//  runs every task of shared on up to iThreads workers, returning once all of
+//  them are done; a single worker is just this thread
+void runWorkers(void *(*worker)(void *), struct Tasks *tasks, void *shared, int iThreads) {
+    tasks->next = 0;
+    if (iThreads > tasks->count) {
+        iThreads = tasks->count;
+    }
+#ifndef _WIN32
+    if (iThreads > 1) {
+        pthread_t *workers = malloc(iThreads * sizeof(pthread_t));
+        if (workers == NULL) {
+            printf("Sorry, but memory was found to be unallocatable for the worker threads.");
+            exit(-1);
+        }
+        pthread_mutex_init(&tasks->lock, NULL);
+        for (int i = 0;i < iThreads;i++) {
+            if (pthread_create(&workers[i], NULL, worker, shared) != 0) {
+                printf("Sorry, but the worker threads could not be started.");
+                exit(-1);
             }
-            //    return i to "j-1"
-            i = ptr;
         }
-
-    } while (ptr->next != NULL);
+        for (int i = 0;i < iThreads;i++) {
+            pthread_join(workers[i], NULL);
+        }
+        pthread_mutex_destroy(&tasks->lock);
+        free(workers);
+        return;
+    }
+    pthread_mutex_init(&tasks->lock, NULL);
+    worker(shared);
+    pthread_mutex_destroy(&tasks->lock);
+#else
+    (void)iThreads;
+    worker(shared);
+#endif
 }
 
+
 //------------------------------------------------------------------------------
-//  Scheduling Methods
+//  Loading Methods
 //------------------------------------------------------------------------------
-void arrivalChecker(struct List *ReadyQueue, struct List *JobQueue, int CLOCK) {
-    struct ProcessNode *arrivalChecker;
-    for (int i = JobQueue->count;i > 0;i--) {
-        arrivalChecker = dequeue(JobQueue);
-        if (arrivalChecker->arrival == CLOCK) {
-            enqueue(ReadyQueue, arrivalChecker);
-        } else {
-            enqueue(JobQueue, arrivalChecker);
-        }
-    }
-}
-
-void npp(struct List *ReadyQueue, struct List *ProcessQueue) {
-    int CLOCK = 0;
-    struct List *JobQueue = init_list();
-    struct ProcessNode *currentProcess;
-    currentProcess = dequeue(ReadyQueue);
-    //    place remaining processes into JobQueue
-    while (ReadyQueue->count > 0) {
-        enqueue(JobQueue, dequeue(ReadyQueue));
-    }
-    while (currentProcess != NULL) {
-        for (int i = 0;i < currentProcess->burst;i++) {
-            CLOCK++;
-            arrivalChecker(ReadyQueue, JobQueue, CLOCK);
-            if (ReadyQueue->head != NULL) { insSortPriority(ReadyQueue); }
-        }
-        currentProcess->waiting = CLOCK - currentProcess->arrival - currentProcess->burst;
-        currentProcess->finish = CLOCK;
-        enqueue(ProcessQueue, currentProcess);
-        arrivalChecker(ReadyQueue, JobQueue, CLOCK);
-        if (ReadyQueue->head != NULL) { insSortPriority(ReadyQueue); }
-        currentProcess = dequeue(ReadyQueue);
-    }
-    free(currentProcess);
-    currentProcess = NULL;
-    del_list(JobQueue);
-}
-
-void rr(struct List *ReadyQueue, struct List *ProcessQueue, int iQuantum) {
-    int CLOCK = 0;
-    struct ProcessNode *currentProcess;
-    struct List *JobQueue = init_list();
-    currentProcess = dequeue(ReadyQueue);
-    //  place remaining processes into JobQueue
-    while (ReadyQueue->count > 0) {
-        enqueue(JobQueue, dequeue(ReadyQueue));
-    }
-    while (currentProcess != NULL) {
-        for (int i = 0;i < iQuantum;i++) {
-            CLOCK++;
-            currentProcess->leftover--;
-            if (i < (iQuantum - 1)) {
-                arrivalChecker(ReadyQueue, JobQueue, CLOCK);
-            }
-            if (currentProcess->leftover == 0) {
-                break;
+//  loads a process table from a binary trace or, failing that, a text input
+//  file, parsed on iThreads threads, and checks it; returns NULL after saying
+//  why, with the exit status for it in iStatus, if it cannot be run
+struct ProcessTable *importTrace(char *cFilepath, int iLimit, int iThreads, int *iStatus) {
+    struct ProcessTable *table;
+    long lMalformed;
+    FILE *file = fopen(cFilepath, "r");
+    *iStatus = 1;
+    if (file == NULL) {
+        printf("Sorry, but there seems to be no such file at %s.\n", cFilepath);
+        return NULL;
+    }
+
+    table = init_table();
+    if (isTrace(cFilepath)) {
+        fclose(file);
+        if (mapTrace(cFilepath, table, iLimit) != 0) {
+            printf("Sorry, but %s is not a complete and consistent binary trace.\n", cFilepath);
+            del_table(table);
+            *iStatus = FAIL_MALFORMED;
+            return NULL;
+        }
+    } else {
+        lMalformed = loadText(cFilepath, file, table, iLimit, iThreads);
+        fclose(file);
+        if (lMalformed > 0) {
+            printf("Sorry, but line %ld of %s is not of the form <pid> <arrival-time> <burst-time> <priority>.\n", lMalformed, cFilepath);
+            del_table(table);
+            *iStatus = FAIL_MALFORMED;
+            return NULL;
+        }
+    }
+    *iStatus = checkTable(table, cFilepath, iLimit);
+    if (*iStatus != 0) {
+        del_table(table);
+        return NULL;
+    }
+    return table;
+}
+
+int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+//  true if any pid is given to more than one process, which is then in pid.
+//  Pids within a few dozen times the count of each other are marked off in a
+//  bitmap, and any others are sorted to bring the same ones together
+int findDuplicatePid(struct ProcessTable *table, int *pid) {
+    unsigned long long *seen;
+    long long llOffset;
+    long long llRange;
+    int *sorted;
+    int iMin = INT_MAX;
+    int iMax = INT_MIN;
+    int iFound = 0;
+
+    for (int i = 0;i < table->count;i++) {
+        if (table->pid[i] < iMin) { iMin = table->pid[i]; }
+        if (table->pid[i] > iMax) { iMax = table->pid[i]; }
+    }
+    llRange = (long long)iMax - iMin + 1;
+    if (llRange <= 64LL * table->count) {
+        seen = calloc((size_t)(llRange / 64 + 1), sizeof(unsigned long long));
+        if (seen == NULL) {
+            printf("Sorry, but memory was found to be unallocatable for the loader.");
+            exit(-1);
+        }
+        for (int i = 0;i < table->count && !iFound;i++) {
+            llOffset = (long long)table->pid[i] - iMin;
+            if (seen[llOffset / 64] & (1ULL << (llOffset % 64))) {
+                *pid = table->pid[i];
+                iFound = 1;
             }
+            seen[llOffset / 64] |= 1ULL << (llOffset % 64);
+        }
+        free(seen);
+        return iFound;
+    }
+    sorted = malloc((size_t)table->count * sizeof(int));
+    if (sorted == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the loader.");
+        exit(-1);
+    }
+    memcpy(sorted, table->pid, (size_t)table->count * sizeof(int));
+    qsort(sorted, table->count, sizeof(int), compareInts);
+    for (int i = 1;i < table->count && !iFound;i++) {
+        if (sorted[i] == sorted[i - 1]) {
+            *pid = sorted[i];
+            iFound = 1;
+        }
+    }
+    free(sorted);
+    return iFound;
+}
+
+//  the one pass a loaded table gets before it is run, turning away an input
+//  with no processes, fewer than the iLimit asked for, a negative burst or
+//  a pid given twice; returns 0, or the exit status after saying why
+int checkTable(struct ProcessTable *table, char *cFilepath, int iLimit) {
+    int pid;
+    if (table->count == 0) {
+        printf("Sorry, but %s holds no processes.\n", cFilepath);
+        return FAIL_EMPTY;
+    }
+    if (iLimit > 0 && table->count < iLimit) {
+        printf("Sorry, but %s holds only %d processes, fewer than the %d asked for.\n", cFilepath, table->count, iLimit);
+        return FAIL_SHORT;
+    }
+    for (int i = 0;i < table->count;i++) {
+        if (table->burst[i] < 0) {
+            printf("Sorry, but process %d of %s has a negative burst time.\n", table->pid[i], cFilepath);
+            return FAIL_NEGATIVE;
+        }
+    }
+    if (findDuplicatePid(table, &pid)) {
+        printf("Sorry, but more than one process of %s has the pid %d.\n", cFilepath, pid);
+        return FAIL_DUPLICATE;
+    }
+    return 0;
+}
+
+//  the value of a command line or manifest argument that must be a positive
+//  integer, or -1 if it is anything else
+int parsePositive(const char *text) {
+    long long llValue = 0;
+    if (*text == '\0') { return -1; }
+    for (const char *c = text;*c != '\0';c++) {
+        if (*c < '0' || *c > '9') { return -1; }
+        llValue = llValue * 10 + (*c - '0');
+        if (llValue > INT_MAX) { return -1; }
+    }
+    return (llValue > 0) ? (int)llValue : -1;
+}
+
+//  the value of a command line argument that must be an integer of either
+//  sign, in *iValue; returns 0, or -1 if it is anything else
+int parseInteger(const char *text, int *iValue) {
+    long long llValue = 0;
+    int iNegative = (*text == '-');
+    const char *c = text + iNegative;
+    if (*c == '\0') { return -1; }
+    for (;*c != '\0';c++) {
+        if (*c < '0' || *c > '9') { return -1; }
+        llValue = llValue * 10 + (*c - '0');
+        if (llValue > INT_MAX) { return -1; }
+    }
+    *iValue = (int)(iNegative ? -llValue : llValue);
+    return 0;
+}
+
+//  the --seed of a benchmark or generated trace, in *seed; returns 0, or -1
+//  if it is not a non-negative integer that fits
+int parseSeed(const char *text, unsigned long long *seed) {
+    unsigned long long value = 0;
+    if (*text == '\0') { return -1; }
+    for (const char *c = text;*c != '\0';c++) {
+        if (*c < '0' || *c > '9' || value > (ULLONG_MAX - (unsigned long long)(*c - '0')) / 10) { return -1; }
+        value = value * 10 + (unsigned long long)(*c - '0');
+    }
+    *seed = value;
+    return 0;
+}
+
+//  loadTrace() of the text input file open as file, but where it is whole and
+//  large enough to share out, parsed from memory on iThreads threads
+long loadText(char *cFilepath, FILE *file, struct ProcessTable *table, int iLimit, int iThreads) {
+    char *text;
+    size_t size;
+    long lMalformed;
+    iThreads = threadCount(iThreads);
+    //  a limited load stops at its limit, which would leave threads idle
+    if (iLimit > 0 || iThreads < 2 || (text = mapFile(cFilepath, &size)) == NULL) {
+        return loadTrace(file, table, iLimit);
+    }
+    if (size < 2 * (size_t)LOAD_BLOCK) {
+        unmapFile(text, size);
+        return loadTrace(file, table, iLimit);
+    }
+    lMalformed = loadTraceParallel(text, size, table, iThreads);
+    unmapFile(text, size);
+    return lMalformed;
+}
+
+//  parses the integers on one line into values, returning how many were found
+//  (0 for a blank line, 4 for a process) or -1 if the line is malformed
+int parseLine(const char *line, const char *end, int *values) {
+    const char *p = line;
+    int iFields = 0;
+    int iNegative;
+    long long llValue;
+
+    while (1) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { p++; }
+        if (p == end) { break; }
+        if (iFields == 4) { return -1; }
+        iNegative = (*p == '-');
+        if (*p == '-' || *p == '+') { p++; }
+        if (p == end || *p < '0' || *p > '9') { return -1; }
+        llValue = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            llValue = llValue * 10 + (*p - '0');
+            if (llValue > (long long)INT_MAX + 1) { return -1; }
+            p++;
         }
-        //  process completed in for loop
-        if (currentProcess->leftover == 0) {
-            currentProcess->waiting = CLOCK - currentProcess->arrival - currentProcess->burst;
-            currentProcess->finish = CLOCK;
-            enqueue(ProcessQueue, currentProcess);
-            arrivalChecker(ReadyQueue, JobQueue, CLOCK);
-            currentProcess = dequeue(ReadyQueue);
+        //  digits must run up to whitespace, and fit in an int
+        if (p < end && *p != ' ' && *p != '\t' && *p != '\r') { return -1; }
+        if (iNegative) { llValue = -llValue; }
+        if (llValue > INT_MAX) { return -1; }
+        values[iFields++] = (int)llValue;
+    }
+    return (iFields == 0 || iFields == 4) ? iFields : -1;
+}
+
+struct TraceReader *init_reader(FILE *file) {
+    struct TraceReader *newReader = malloc(sizeof(struct TraceReader));
+    if (newReader == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the loader.");
+        exit(-1);
+    }
+    newReader->buffer = malloc(LOAD_BLOCK);
+    if (newReader->buffer == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the loader.");
+        exit(-1);
+    }
+    newReader->file = file;
+    newReader->line = newReader->buffer;
+    newReader->end = newReader->buffer;
+    newReader->eof = 0;
+    newReader->lLine = 0;
+    return newReader;
+}
+
+void del_reader(struct TraceReader *reader) {
+    free(reader->buffer);
+    free(reader);
+    reader = NULL;
+}
+
+//  reads the next process into values, returning 1, or 0 at the end of the
+//  trace, or -1 if line reader->lLine is malformed
+int readProcess(struct TraceReader *reader, int *values) {
+    char *newline;
+    size_t carry;
+    size_t bytesRead;
+    int iFields;
+
+    while (1) {
+        newline = memchr(reader->line, '\n', reader->end - reader->line);
+        if (newline == NULL && !reader->eof) {
+            //  carry the partial line over to the front of the next block
+            carry = reader->end - reader->line;
+            if (carry == LOAD_BLOCK) {
+                //  no newline in a whole block
+                reader->lLine++;
+                return -1;
+            }
+            memmove(reader->buffer, reader->line, carry);
+            bytesRead = fread(reader->buffer + carry, 1, LOAD_BLOCK - carry, reader->file);
+            reader->line = reader->buffer;
+            reader->end = reader->buffer + carry + bytesRead;
+            reader->eof = (bytesRead == 0);
             continue;
         }
-        //  process incomplete
-        enqueue(ReadyQueue, currentProcess);
-        arrivalChecker(ReadyQueue, JobQueue, CLOCK);
-        currentProcess = dequeue(ReadyQueue);
+        if (newline == NULL) {
+            //  at eof the last line needs no newline
+            if (reader->line == reader->end) { return 0; }
+            newline = reader->end;
+        }
+        reader->lLine++;
+        iFields = parseLine(reader->line, newline, values);
+        reader->line = (newline < reader->end) ? newline + 1 : newline;
+        if (iFields == 4) { return 1; }
+        if (iFields != 0) { return -1; }
     }
-    del_list(JobQueue);
 }
 
-//  send ReadyQueue to designated subroutine for processing
-struct List *processQueue(struct List *ReadyQueue, char *cAlgorithm, int iQuantum) {
-    struct List *ProcessQueue = init_list();
-    if (strcmp(cAlgorithm, "NPP") == 0) {
-        npp(ReadyQueue, ProcessQueue);
-    } else if (strcmp(cAlgorithm, "RR") == 0) {
-        rr(ReadyQueue, ProcessQueue, iQuantum);
+//  appends one process per line of the trace to the table, stopping after
+//  iLimit processes when iLimit > 0; returns 0 on success or the number of the
+//  first malformed line
+long loadTrace(FILE *file, struct ProcessTable *table, int iLimit) {
+    struct TraceReader *reader = init_reader(file);
+    long lMalformed = 0;
+    int values[4];
+    int iRead;
+
+    while ((iLimit <= 0 || table->count < iLimit) && (iRead = readProcess(reader, values)) != 0) {
+        if (iRead < 0) {
+            lMalformed = reader->lLine;
+            break;
+        }
+        tableAppend(table, values[0], values[1], values[2], values[3]);
+    }
+    del_reader(reader);
+    return lMalformed;
+}
+
+//  parses every line of a chunk as readProcess() would, stopping at the first
+//  malformed one
+void parseChunk(struct ParseChunk *chunk) {
+    const char *line = chunk->start;
+    const char *newline;
+    int values[4];
+    int iFields;
+
+    while (line < chunk->end) {
+        newline = memchr(line, '\n', chunk->end - line);
+        if (newline == NULL) {
+            newline = chunk->end;
+        }
+        chunk->lLines++;
+        //  a line too long for readProcess()'s buffer is malformed here too
+        iFields = (newline - line >= LOAD_BLOCK) ? -1 : parseLine(line, newline, values);
+        if (iFields == 4) {
+            if (chunk->count == chunk->capacity) {
+                chunk->capacity = (chunk->capacity == 0) ? 4096 : chunk->capacity * 2;
+                chunk->values = realloc(chunk->values, (size_t)chunk->capacity * 4 * sizeof(int));
+                if (chunk->values == NULL) {
+                    printf("Sorry, but memory was found to be unallocatable for the loader.");
+                    exit(-1);
+                }
+            }
+            memcpy(chunk->values + (size_t)chunk->count * 4, values, 4 * sizeof(int));
+            chunk->count++;
+        } else if (iFields != 0) {
+            chunk->lMalformed = chunk->lLines;
+            return;
+        }
+        line = newline + 1;
+    }
+}
+
+//  parses chunks, or copies parsed ones into the table, until none are left
+void *parseWorker(void *arg) {
+    struct Parse *parse = arg;
+    struct ParseChunk *chunk;
+    int iChunk;
+    int *values;
+
+    while ((iChunk = takeTask(&parse->tasks)) != -1) {
+        chunk = &parse->chunks[iChunk];
+        if (!parse->iFilling) {
+            parseChunk(chunk);
+            continue;
+        }
+        for (int i = 0;i < chunk->count;i++) {
+            values = chunk->values + (size_t)i * 4;
+            tableFill(parse->table, chunk->iRow + i, values[0], values[1], values[2], values[3]);
+        }
+    }
+    return NULL;
+}
+
+//  loadTrace() of a whole text input file in memory, cut on newlines into
+//  chunks of at least a LOAD_BLOCK each, a few per thread so that none sits
+//  idle for long, and copied into the table in input order
+long loadTraceParallel(char *text, size_t size, struct ProcessTable *table, int iThreads) {
+    struct Parse parse;
+    struct ParseChunk *chunk;
+    const char *start;
+    const char *share;
+    const char *newline;
+    long lLine = 0;
+    long lMalformed = 0;
+    int iRows = 0;
+
+    parse.tasks.count = iThreads * 4;
+    if ((size_t)parse.tasks.count > size / LOAD_BLOCK) {
+        parse.tasks.count = (int)(size / LOAD_BLOCK);
+    }
+    parse.chunks = calloc(parse.tasks.count, sizeof(struct ParseChunk));
+    if (parse.chunks == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the loader.");
+        exit(-1);
+    }
+    parse.table = table;
+    parse.iFilling = 0;
+    start = text;
+    for (int i = 0;i < parse.tasks.count;i++) {
+        chunk = &parse.chunks[i];
+        chunk->start = start;
+        chunk->end = text + size;
+        //  each chunk but the last runs to the newline after its even share,
+        //  and is empty if the chunk before ran past that
+        share = text + size * (i + 1) / parse.tasks.count;
+        if (i < parse.tasks.count - 1 && share <= start) {
+            chunk->end = start;
+        } else if (i < parse.tasks.count - 1 && (newline = memchr(share, '\n', text + size - share)) != NULL) {
+            chunk->end = newline + 1;
+        }
+        start = chunk->end;
+    }
+    runWorkers(parseWorker, &parse.tasks, &parse, iThreads);
+
+    //  the first malformed line is numbered by the lines of the chunks ahead
+    for (int i = 0;i < parse.tasks.count;i++) {
+        chunk = &parse.chunks[i];
+        if (chunk->lMalformed > 0) {
+            lMalformed = lLine + chunk->lMalformed;
+            break;
+        }
+        lLine += chunk->lLines;
+        chunk->iRow = iRows;
+        iRows += chunk->count;
+    }
+    if (lMalformed == 0 && iRows > 0) {
+        tableReserve(table, iRows);
+        table->count = iRows;
+        parse.iFilling = 1;
+        runWorkers(parseWorker, &parse.tasks, &parse, iThreads);
+    }
+    for (int i = 0;i < parse.tasks.count;i++) {
+        free(parse.chunks[i].values);
+    }
+    free(parse.chunks);
+    return lMalformed;
+}
+
+//  true if the file starts with the binary trace magic
+int isTrace(char *cFilepath) {
+    char magic[8];
+    int iTrace = 0;
+    FILE *file = fopen(cFilepath, "rb");
+    if (file == NULL) { return 0; }
+    if (fread(magic, 1, sizeof(magic), file) == sizeof(magic)) {
+        iTrace = (memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0);
+    }
+    fclose(file);
+    return iTrace;
+}
+
+//  the whole of a file read-only in memory, or NULL if it is empty or cannot
+//  be read
+char *mapFile(char *cFilepath, size_t *size) {
+    char *mapping;
+#ifndef _WIN32
+    struct stat info;
+    int fd = open(cFilepath, O_RDONLY);
+    if (fd < 0) { return NULL; }
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)info.st_size;
+    mapping = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) { return NULL; }
+#else
+    FILE *file = fopen(cFilepath, "rb");
+    if (file == NULL) { return NULL; }
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    mapping = (*size > 0) ? malloc(*size) : NULL;
+    if (mapping == NULL || fread(mapping, 1, *size, file) != *size) {
+        free(mapping);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+#endif
+    return mapping;
+}
+
+void unmapFile(char *mapping, size_t size) {
+#ifndef _WIN32
+    munmap(mapping, size);
+#else
+    (void)size;
+    free(mapping);
+#endif
+}
+
+//  points the table's input columns straight at a mapped binary trace, so
+//  only leftover, finish, waiting, started and preemptions are allocated;
+//  returns 0 on success, or -1 if the trace is cut short or its stored order
+//  is not the processes after the first in stable arrival order
+int mapTrace(char *cFilepath, struct ProcessTable *table, int iLimit) {
+    struct TraceHeader header;
+    size_t size;
+    int *order;
+    int iCount;
+    char *mapping = mapFile(cFilepath, &size);
+    if (mapping == NULL) { return -1; }
+    table->mapping = mapping;
+    table->mappingSize = size;
+    if (size < sizeof(header)) { return -1; }
+    memcpy(&header, mapping, sizeof(header));
+    iCount = header.count;
+    if (header.version != TRACE_VERSION || iCount < 0
+        || size < sizeof(header) + ((size_t)iCount * 5 - (iCount > 0)) * sizeof(int)) {
+        return -1;
+    }
+
+    table->pid = (int *)(mapping + sizeof(header));
+    table->arrival = table->pid + iCount;
+    table->burst = table->arrival + iCount;
+    table->priority = table->burst + iCount;
+    //  the stored arrival order only holds for the whole trace. Its rows are
+    //  used as they are, so each must be in range and follow the one before
+    //  it, arriving later or with the same arrival further down the table,
+    //  which also makes every row appear only once
+    if (iLimit > 0 && iLimit < iCount) {
+        iCount = iLimit;
+    } else {
+        order = table->priority + iCount;
+        for (int i = 0;i < iCount - 1;i++) {
+            if (order[i] < 1 || order[i] >= iCount) { return -1; }
+            if (i > 0 && (table->arrival[order[i]] < table->arrival[order[i - 1]]
+                || (table->arrival[order[i]] == table->arrival[order[i - 1]] && order[i] <= order[i - 1]))) {
+                return -1;
+            }
+        }
+        table->order = order;
+    }
+    table->count = iCount;
+    table->capacity = iCount;
+
+    table->leftover = malloc(((size_t)iCount + 1) * sizeof(int));
+    table->finish = calloc((size_t)iCount + 1, sizeof(long long));
+    table->waiting = calloc((size_t)iCount + 1, sizeof(long long));
+    table->started = malloc(((size_t)iCount + 1) * sizeof(long long));
+    table->preemptions = calloc((size_t)iCount + 1, sizeof(int));
+    if (table->leftover == NULL || table->finish == NULL || table->waiting == NULL || table->started == NULL || table->preemptions == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the process table.");
+        exit(-1);
+    }
+    memcpy(table->leftover, table->burst, (size_t)iCount * sizeof(int));
+    memset(table->started, 0xff, ((size_t)iCount + 1) * sizeof(long long));
+    return 0;
+}
+
+//  ./sched convert: parses a text input file and writes it as a binary trace
+int convertTrace(char *cInputFilepath, char *cTraceFilepath, int iThreads) {
+    struct TraceHeader header;
+    struct ProcessTable *table;
+    struct Arena *arena;
+    struct IndexQueue *JobQueue;
+    long lMalformed;
+    int iStatus;
+    FILE *file = fopen(cInputFilepath, "r");
+    if (file == NULL) {
+        printf("Sorry, but there seems to be no such file at %s.\n", cInputFilepath);
+        return 1;
+    }
+    table = init_table();
+    lMalformed = loadText(cInputFilepath, file, table, 0, iThreads);
+    fclose(file);
+    if (lMalformed > 0) {
+        printf("Sorry, but line %ld of %s is not of the form <pid> <arrival-time> <burst-time> <priority>.\n", lMalformed, cInputFilepath);
+        del_table(table);
+        return FAIL_MALFORMED;
+    }
+    iStatus = checkTable(table, cInputFilepath, 0);
+    if (iStatus != 0) {
+        del_table(table);
+        return iStatus;
+    }
+
+    file = fopen(cTraceFilepath, "wb");
+    if (file == NULL) {
+        printf("Sorry, but the file %s could not be created.\n", cTraceFilepath);
+        del_table(table);
+        return 1;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.count = table->count;
+    arena = init_arena();
+    JobQueue = init_job_queue(table, arena, iThreads);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(table->pid, sizeof(int), table->count, file);
+    fwrite(table->arrival, sizeof(int), table->count, file);
+    fwrite(table->burst, sizeof(int), table->count, file);
+    fwrite(table->priority, sizeof(int), table->count, file);
+    fwrite(JobQueue->items, sizeof(int), JobQueue->count, file);
+    if (fclose(file) != 0) {
+        printf("Sorry, but the file %s could not be written.\n", cTraceFilepath);
+        del_arena(arena);
+        del_table(table);
+        return 1;
+    }
+    printf("Converted %d processes from %s into %s.\n", table->count, cInputFilepath, cTraceFilepath);
+    del_arena(arena);
+    del_table(table);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//  Writing Methods
+//------------------------------------------------------------------------------
+struct Writer *init_writer(FILE *file) {
+    struct Writer *newWriter = malloc(sizeof(struct Writer));
+    if (newWriter == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the writer.");
+        exit(-1);
+    }
+    newWriter->buffer = malloc(WRITE_BLOCK);
+    if (newWriter->buffer == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the writer.");
+        exit(-1);
+    }
+    newWriter->file = file;
+    newWriter->used = 0;
+    newWriter->failed = 0;
+    return newWriter;
+}
+
+//  flushes whatever is left and returns 0, or -1 if any write failed
+int del_writer(struct Writer *writer) {
+    int iFailed;
+    writerFlush(writer);
+    iFailed = writer->failed;
+    free(writer->buffer);
+    free(writer);
+    writer = NULL;
+    return iFailed ? -1 : 0;
+}
+
+void writerFlush(struct Writer *writer) {
+    if (writer->used > 0 && fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used) {
+        writer->failed = 1;
+    }
+    writer->used = 0;
+}
+
+//  formats an int two digits at a time into the buffer
+void writeInt(struct Writer *writer, long long value) {
+    static const char cDigits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char cReversed[20];
+    char *out = writer->buffer + writer->used;
+    unsigned long long uValue = (value < 0) ? 0ull - (unsigned long long)value : (unsigned long long)value;
+    int iLength = 0;
+
+    while (uValue >= 100) {
+        unsigned int uPair = (unsigned int)(uValue % 100) * 2;
+        uValue /= 100;
+        cReversed[iLength++] = cDigits[uPair + 1];
+        cReversed[iLength++] = cDigits[uPair];
+    }
+    if (uValue >= 10) {
+        cReversed[iLength++] = cDigits[uValue * 2 + 1];
+        cReversed[iLength++] = cDigits[uValue * 2];
+    } else {
+        cReversed[iLength++] = (char)('0' + uValue);
+    }
+    if (value < 0) {
+        *out++ = '-';
+    }
+    while (iLength > 0) {
+        *out++ = cReversed[--iLength];
+    }
+    writer->used = out - writer->buffer;
+}
+
+//  appends one "<pid> <arrival-time> <finish-time> <waiting-time>" record and
+//  its preemptions, -1 for a run not modelling context switches, as five
+//  packed 64-bit ints or as a text line, which leaves out a -1
+void writeResult(struct Writer *writer, int iBinary, int pid, int arrival, long long finish, long long waiting, int preemptions) {
+    //  room for five values of up to 20 characters and their separators
+    if (writer->used + 112 > WRITE_BLOCK) {
+        writerFlush(writer);
+    }
+    if (iBinary) {
+        long long record[5];
+        record[0] = pid;
+        record[1] = arrival;
+        record[2] = finish;
+        record[3] = waiting;
+        record[4] = preemptions;
+        memcpy(writer->buffer + writer->used, record, sizeof(record));
+        writer->used += sizeof(record);
+        return;
+    }
+    writeInt(writer, pid);
+    writer->buffer[writer->used++] = ' ';
+    writeInt(writer, arrival);
+    writer->buffer[writer->used++] = ' ';
+    writeInt(writer, finish);
+    writer->buffer[writer->used++] = ' ';
+    writeInt(writer, waiting);
+    if (preemptions != -1) {
+        writer->buffer[writer->used++] = ' ';
+        writeInt(writer, preemptions);
+    }
+    writer->buffer[writer->used++] = '\n';
+}
+
+//  the header of a --binary results file
+void writeResultsHeader(FILE *file, int count) {
+    struct TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RESULTS_MAGIC, sizeof(header.magic));
+    header.version = RESULTS_VERSION;
+    header.count = count;
+    fwrite(&header, sizeof(header), 1, file);
+}
+
+//------------------------------------------------------------------------------
+//  Arena Methods
+//------------------------------------------------------------------------------
+struct Arena *init_arena() {
+    struct Arena *newArena = malloc(sizeof(struct Arena));
+    if (newArena == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the arena.");
+        exit(-1);
+    }
+    newArena->slabs = NULL;
+    newArena->spare = NULL;
+    return newArena;
+}
+
+void del_arena(struct Arena *arena) {
+    struct ArenaSlab *slab;
+    while (arena->slabs != NULL) {
+        slab = arena->slabs;
+        arena->slabs = slab->next;
+        free(slab);
+    }
+    while (arena->spare != NULL) {
+        slab = arena->spare;
+        arena->spare = slab->next;
+        free(slab);
+    }
+    free(arena);
+    arena = NULL;
+}
+
+//  empties the arena for another run, keeping its slabs to be handed out again
+void arenaReset(struct Arena *arena) {
+    struct ArenaSlab *slab;
+    while (arena->slabs != NULL) {
+        slab = arena->slabs;
+        arena->slabs = slab->next;
+        slab->next = arena->spare;
+        arena->spare = slab;
+    }
+}
+
+//  carve size bytes off the newest slab, opening a fresh one when it runs out
+void *arenaAlloc(struct Arena *arena, size_t size) {
+    struct ArenaSlab *slab = arena->slabs;
+    size_t header = (sizeof(struct ArenaSlab) + 15) & ~(size_t)15;
+    void *ptr;
+
+    size = (size + 15) & ~(size_t)15;
+    if (slab == NULL || slab->used + size > slab->size) {
+        size_t slabSize = 1 << 20;
+        if (size > slabSize - header) {
+            slabSize = header + size;
+        }
+        //  a spare slab big enough is taken before a new one is allocated
+        struct ArenaSlab **spare = &arena->spare;
+        while (*spare != NULL && (*spare)->size < slabSize) {
+            spare = &(*spare)->next;
+        }
+        if (*spare != NULL) {
+            slab = *spare;
+            *spare = slab->next;
+        } else {
+            slab = malloc(slabSize);
+            if (slab == NULL) {
+                printf("Sorry, but memory was found to be unallocatable for the arena.");
+                exit(-1);
+            }
+            slab->size = slabSize;
+        }
+        slab->next = arena->slabs;
+        slab->used = header;
+        arena->slabs = slab;
+    }
+    ptr = (char *)slab + slab->used;
+    slab->used += size;
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+//  Queuing Methods
+//------------------------------------------------------------------------------
+struct IndexQueue *init_queue(struct Arena *arena, int capacity) {
+    struct IndexQueue *newQueue = arenaAlloc(arena, sizeof(struct IndexQueue));
+    int iCapacity = 16;
+    while (iCapacity < capacity) {
+        iCapacity <<= 1;
+    }
+    newQueue->items = arenaAlloc(arena, iCapacity * sizeof(int));
+    newQueue->head = 0;
+    newQueue->count = 0;
+    newQueue->capacity = iCapacity;
+    newQueue->arena = arena;
+    return newQueue;
+}
+
+//  moves a full queue into a ring of twice the size; the old ring stays in the
+//  arena, so a queue costs at most twice its peak
+void growQueue(struct IndexQueue *queue) {
+    int iCapacity = queue->capacity * 2;
+    int *items = arenaAlloc(queue->arena, iCapacity * sizeof(int));
+    for (int i = 0;i < queue->count;i++) {
+        items[i] = queue->items[(queue->head + i) & (queue->capacity - 1)];
+    }
+    queue->items = items;
+    queue->head = 0;
+    queue->capacity = iCapacity;
+}
+
+void enqueue(struct IndexQueue *queue, int index) {
+    if (queue->count == queue->capacity) {
+        growQueue(queue);
+    }
+    queue->items[(queue->head + queue->count) & (queue->capacity - 1)] = index;
+    queue->count++;
+}
+
+//  returns the row index at the front of the queue, or -1 if it is empty
+int dequeue(struct IndexQueue *queue) {
+    int iIndex;
+    if (queue->count == 0) { return -1; }
+    iIndex = queue->items[queue->head];
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->count--;
+    return iIndex;
+}
+
+//------------------------------------------------------------------------------
+//  Heap Methods
+//------------------------------------------------------------------------------
+struct Heap *init_heap(struct Arena *arena, int capacity) {
+    struct Heap *newHeap = arenaAlloc(arena, sizeof(struct Heap));
+    newHeap->entries = arenaAlloc(arena, capacity * sizeof(struct HeapEntry));
+    newHeap->count = 0;
+    newHeap->capacity = capacity;
+    newHeap->seq = 0;
+    newHeap->arena = arena;
+    newHeap->position = NULL;
+    newHeap->positions = 0;
+    return newHeap;
+}
+
+//  a heap that also tracks where each row index sits, for rows below rows
+//  to begin with
+struct Heap *init_indexed_heap(struct Arena *arena, int capacity, int rows) {
+    struct Heap *newHeap = init_heap(arena, capacity);
+    newHeap->positions = (rows > 0) ? rows : 1024;
+    newHeap->position = arenaAlloc(arena, newHeap->positions * sizeof(int));
+    memset(newHeap->position, -1, newHeap->positions * sizeof(int));
+    return newHeap;
+}
+
+//  true if entry a should be scheduled before entry b
+int heapBefore(struct HeapEntry *a, struct HeapEntry *b) {
+    if (a->key != b->key) {
+        return a->key < b->key;
+    }
+    return a->seq < b->seq;
+}
+
+//  puts entry in slot i, keeping the position of an indexed heap
+void heapPlace(struct Heap *heap, int i, struct HeapEntry entry) {
+    heap->entries[i] = entry;
+    if (heap->position != NULL) {
+        heap->position[entry.index] = i;
+    }
+}
+
+//  moves entry from slot i up or down to where it belongs
+void heapSift(struct Heap *heap, int i, struct HeapEntry entry) {
+    int child;
+    while (i > 0 && heapBefore(&entry, &heap->entries[(i - 1) / 2])) {
+        heapPlace(heap, i, heap->entries[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    while ((child = 2 * i + 1) < heap->count) {
+        if (child + 1 < heap->count && heapBefore(&heap->entries[child + 1], &heap->entries[child])) {
+            child++;
+        }
+        if (!heapBefore(&heap->entries[child], &entry)) { break; }
+        heapPlace(heap, i, heap->entries[child]);
+        i = child;
+    }
+    heapPlace(heap, i, entry);
+}
+
+void heapPush(struct Heap *heap, int index, long long key) {
+    struct HeapEntry entry;
+    if (heap->count == heap->capacity) {
+        //  as with growQueue(), the old entries stay behind in the arena
+        struct HeapEntry *entries;
+        heap->capacity = (heap->capacity > 0) ? heap->capacity * 2 : 1024;
+        entries = arenaAlloc(heap->arena, heap->capacity * sizeof(struct HeapEntry));
+        memcpy(entries, heap->entries, heap->count * sizeof(struct HeapEntry));
+        heap->entries = entries;
+    }
+    if (heap->position != NULL && index >= heap->positions) {
+        int iPositions = heap->positions;
+        int *position;
+        while (iPositions <= index) {
+            iPositions *= 2;
+        }
+        position = arenaAlloc(heap->arena, iPositions * sizeof(int));
+        memcpy(position, heap->position, heap->positions * sizeof(int));
+        memset(position + heap->positions, -1, (iPositions - heap->positions) * sizeof(int));
+        heap->position = position;
+        heap->positions = iPositions;
+    }
+    entry.index = index;
+    entry.key = key;
+    entry.seq = heap->seq++;
+    heapSift(heap, heap->count++, entry);
+}
+
+//  returns the row index at the top of the heap, or -1 if it is empty
+int heapPop(struct Heap *heap) {
+    int iTop;
+    if (heap->count == 0) { return -1; }
+    iTop = heap->entries[0].index;
+    heapRemove(heap, iTop);
+    return iTop;
+}
+
+//  whether index is in an indexed heap
+int heapHas(struct Heap *heap, int index) {
+    return index < heap->positions && heap->position[index] != -1;
+}
+
+//  gives index a new key, its place among equal keys unchanged
+void heapUpdate(struct Heap *heap, int index, long long key) {
+    int i = heap->position[index];
+    struct HeapEntry entry = heap->entries[i];
+    entry.key = key;
+    heapSift(heap, i, entry);
+}
+
+//  takes index out of the heap, filling its slot with the last entry; only
+//  the top may be removed from a heap that is not indexed
+void heapRemove(struct Heap *heap, int index) {
+    int i = (heap->position != NULL) ? heap->position[index] : 0;
+    struct HeapEntry last = heap->entries[--heap->count];
+    if (heap->position != NULL) {
+        heap->position[index] = -1;
+    }
+    if (i < heap->count) {
+        heapSift(heap, i, last);
+    }
+}
+
+//------------------------------------------------------------------------------
+//  Statistics Methods
+//------------------------------------------------------------------------------
+struct Stats *init_stats(struct Arena *arena) {
+    struct Stats *newStats = arenaAlloc(arena, sizeof(struct Stats));
+    memset(newStats, 0, sizeof(struct Stats));
+    return newStats;
+}
+
+//  index of the highest set bit of a non-zero mask
+int highestBit(unsigned long long mask) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(mask);
+#else
+    int i = 0;
+    while (mask >>= 1) {
+        i++;
+    }
+    return i;
+#endif
+}
+
+//  the bucket of a value: itself while small, and otherwise its top
+//  HISTOGRAM_BITS + 1 bits, offset by how far they had to be shifted down
+int histogramBucket(long long value) {
+    int iShift;
+    if (value < (2LL << HISTOGRAM_BITS)) {
+        return (value > 0) ? (int)value : 0;
+    }
+    iShift = highestBit((unsigned long long)value) - HISTOGRAM_BITS;
+    return ((iShift + 1) << HISTOGRAM_BITS) + (int)((value >> iShift) - (1LL << HISTOGRAM_BITS));
+}
+
+//  the greatest value counted in a bucket
+long long histogramValue(int bucket) {
+    int iShift;
+    if (bucket < (2 << HISTOGRAM_BITS)) {
+        return bucket;
+    }
+    iShift = (bucket >> HISTOGRAM_BITS) - 1;
+    return (((1LL << HISTOGRAM_BITS) + (bucket & ((1 << HISTOGRAM_BITS) - 1)) + 1) << iShift) - 1;
+}
+
+void histogramRecord(struct Histogram *histogram, long long value) {
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (histogram->count == 0 || value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count++;
+    if (value < 0) {
+        histogram->below++;
+    } else {
+        histogram->counts[histogramBucket(value)]++;
+    }
+}
+
+//  a value dPercentile percent of those recorded are at or below, too high by
+//  less than a bucket and never outside the least and greatest recorded
+long long histogramPercentile(struct Histogram *histogram, double dPercentile) {
+    long long llRank = (long long)(dPercentile / 100.0 * (double)histogram->count + 0.999999);
+    long long llSeen = histogram->below;
+    long long llValue = histogram->max;
+    if (histogram->count == 0) { return 0; }
+    if (llRank < 1) {
+        llRank = 1;
+    }
+    if (llRank <= llSeen) { return histogram->min; }
+    for (int i = 0;i < HISTOGRAM_BUCKETS;i++) {
+        llSeen += histogram->counts[i];
+        if (llSeen >= llRank) {
+            llValue = histogramValue(i);
+            break;
+        }
+    }
+    if (llValue < histogram->min) { return histogram->min; }
+    return (llValue > histogram->max) ? histogram->max : llValue;
+}
+
+void printPercentiles(char *cName, struct Histogram *histogram) {
+    printf("Half of the processes had a %s time of at most %lld, 90%% at most %lld, 99%% at most %lld, and 99.9%% at most %lld.\n", cName,
+        histogramPercentile(histogram, 50.0), histogramPercentile(histogram, 90.0), histogramPercentile(histogram, 99.0), histogramPercentile(histogram, 99.9));
+}
+
+//  adds to totals[0] the turnover, finish - arrival, and to totals[1] the
+//  wait, that less the burst, of every process in rows [i, n) that has run;
+//  one that never started has no finish to count
+void sumTotalsScalar(const long long *finish, const long long *started, const int *arrival, const int *burst, int i, int n, long long *totals) {
+    for (;i < n;i++) {
+        if (started[i] != -1) {
+            totals[0] += finish[i] - arrival[i];
+            totals[1] += finish[i] - arrival[i] - burst[i];
+        }
+    }
+}
+
+//  the vector kernels sum as many whole vectors of rows as there are, each
+//  lane masked off for a process that never started, and return how far they
+//  got for the scalar loop to finish
+#ifdef SCHED_AVX2
+__attribute__((target("avx2"))) int sumTotalsAvx2(const long long *finish, const long long *started, const int *arrival, const int *burst, int n, long long *totals) {
+    __m256i turnover = _mm256_setzero_si256();
+    __m256i wait = _mm256_setzero_si256();
+    __m256i unstarted;
+    __m256i spans;
+    long long lanes[4];
+    int i = 0;
+    for (;i + 4 <= n;i += 4) {
+        unstarted = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(started + i)), _mm256_set1_epi64x(-1));
+        spans = _mm256_andnot_si256(unstarted, _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *)(finish + i)),
+            _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(arrival + i)))));
+        turnover = _mm256_add_epi64(turnover, spans);
+        wait = _mm256_add_epi64(wait, _mm256_sub_epi64(spans,
+            _mm256_andnot_si256(unstarted, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(burst + i))))));
+    }
+    _mm256_storeu_si256((__m256i *)lanes, turnover);
+    totals[0] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, wait);
+    totals[1] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return i;
+}
+#endif
+
+#ifdef SCHED_NEON
+int sumTotalsNeon(const long long *finish, const long long *started, const int *arrival, const int *burst, int n, long long *totals) {
+    int64x2_t turnover = vdupq_n_s64(0);
+    int64x2_t wait = vdupq_n_s64(0);
+    int64x2_t unstarted;
+    int64x2_t spans;
+    int i = 0;
+    for (;i + 2 <= n;i += 2) {
+        unstarted = vreinterpretq_s64_u64(vceqq_s64(vld1q_s64((const int64_t *)(started + i)), vdupq_n_s64(-1)));
+        spans = vbicq_s64(vsubq_s64(vld1q_s64((const int64_t *)(finish + i)), vmovl_s32(vld1_s32(arrival + i))), unstarted);
+        turnover = vaddq_s64(turnover, spans);
+        wait = vaddq_s64(wait, vsubq_s64(spans, vbicq_s64(vmovl_s32(vld1_s32(burst + i)), unstarted)));
+    }
+    totals[0] += vaddvq_s64(turnover);
+    totals[1] += vaddvq_s64(wait);
+    return i;
+}
+#endif
+
+//  the totals of a run that kept its table, summed from its columns once it
+//  is done rather than as each process finishes
+void sumTotals(struct Engine *engine) {
+    struct ProcessTable *table = engine->table;
+    long long totals[2] = {0, 0};
+    int i = 0;
+#if defined(SCHED_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        i = sumTotalsAvx2(table->finish, table->started, table->arrival, table->burst, table->count, totals);
+    }
+#elif defined(SCHED_NEON)
+    i = sumTotalsNeon(table->finish, table->started, table->arrival, table->burst, table->count, totals);
+#endif
+    sumTotalsScalar(table->finish, table->started, table->arrival, table->burst, i, table->count, totals);
+    engine->llTurnover = totals[0];
+    engine->llWait = totals[1];
+}
+
+//------------------------------------------------------------------------------
+//  Timeline Methods
+//------------------------------------------------------------------------------
+//  a timeline whose log is an anonymous temporary file, or NULL after saying
+//  why if none can be made
+struct Timeline *init_timeline() {
+    struct Timeline *newTimeline = malloc(sizeof(struct Timeline));
+    if (newTimeline == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the timeline.");
+        exit(-1);
+    }
+    newTimeline->events = malloc(TIMELINE_BLOCK * sizeof(struct Event));
+    if (newTimeline->events == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the timeline.");
+        exit(-1);
+    }
+    newTimeline->log = tmpfile();
+    if (newTimeline->log == NULL) {
+        printf("Sorry, but no temporary file could be created to log the timeline in.\n");
+        free(newTimeline->events);
+        free(newTimeline);
+        return NULL;
+    }
+    newTimeline->used = 0;
+    newTimeline->failed = 0;
+    return newTimeline;
+}
+
+void del_timeline(struct Timeline *timeline) {
+    fclose(timeline->log);
+    free(timeline->events);
+    free(timeline);
+    timeline = NULL;
+}
+
+//  appends one event to the block, spilling the block first if it is full. A
+//  slice or switch is never longer than an int, but a stretch of rounds that
+//  is goes in as several
+void timelineRecord(struct Timeline *timeline, int type, int cpu, int pid, int rounds, long long start, long long end) {
+    struct Event *event;
+    for (;;) {
+        if (timeline->used == TIMELINE_BLOCK) {
+            timelineSpill(timeline);
+        }
+        event = &timeline->events[timeline->used++];
+        event->start = start;
+        event->length = (end - start > INT_MAX) ? INT_MAX : (int)(end - start);
+        event->type = type;
+        event->cpu = cpu;
+        event->pid = pid;
+        event->rounds = rounds;
+        if (end - start <= INT_MAX) { return; }
+        start += INT_MAX;
+    }
+}
+
+void timelineSpill(struct Timeline *timeline) {
+    if (timeline->used > 0 && fwrite(timeline->events, sizeof(struct Event), timeline->used, timeline->log) != (size_t)timeline->used) {
+        timeline->failed = 1;
+    }
+    timeline->used = 0;
+}
+
+//  copies a string into the buffer, which the caller has made room for
+void writeText(struct Writer *writer, const char *text) {
+    size_t length = strlen(text);
+    memcpy(writer->buffer + writer->used, text, length);
+    writer->used += length;
+}
+
+//  appends one event of the trace JSON: a complete event on the track of its
+//  CPU, or an instant one on the track after the CPUs for an arrival. Trace
+//  timestamps are in microseconds, so each ms is written as 1000 of them
+void writeEvent(struct Writer *writer, struct Event *event, int iCpus) {
+    static const char *cCategories[] = {"arrival", "slice", "finish", "switch", "rounds"};
+    static const char *cArgs[] = {"pid", "pid", "pid", "from", "processes"};
+    //  room for five values of up to 20 characters and the text around them
+    if (writer->used + 256 > WRITE_BLOCK) {
+        writerFlush(writer);
+    }
+    writeText(writer, (event->type == EVENT_ARRIVAL) ? ",\n{\"ph\":\"i\",\"s\":\"t\"" : ",\n{\"ph\":\"X\"");
+    writeText(writer, ",\"pid\":0,\"tid\":");
+    writeInt(writer, (event->cpu >= 0) ? event->cpu : iCpus);
+    writeText(writer, ",\"ts\":");
+    writeInt(writer, event->start * 1000);
+    if (event->type != EVENT_ARRIVAL) {
+        writeText(writer, ",\"dur\":");
+        writeInt(writer, (long long)event->length * 1000);
+    }
+    writeText(writer, ",\"cat\":\"");
+    writeText(writer, cCategories[event->type]);
+    if (event->type == EVENT_SWITCH) {
+        writeText(writer, "\",\"name\":\"switch\"");
+    } else if (event->type == EVENT_ROUNDS) {
+        writeText(writer, "\",\"name\":\"RR rounds\"");
+    } else {
+        writeText(writer, "\",\"name\":\"P");
+        writeInt(writer, event->pid);
+        writeText(writer, "\"");
+    }
+    if (event->pid >= 0) {
+        writeText(writer, ",\"args\":{\"");
+        writeText(writer, cArgs[event->type]);
+        writeText(writer, "\":");
+        writeInt(writer, event->pid);
+        if (event->type == EVENT_ROUNDS) {
+            writeText(writer, ",\"rounds\":");
+            writeInt(writer, event->rounds);
+        }
+        writeText(writer, "}");
+    }
+    writeText(writer, "}");
+}
+
+//  writes the whole timeline to file as Chrome trace JSON, which Perfetto and
+//  chrome://tracing open as one track per CPU and one of arrivals; returns 0,
+//  or -1 if the log or the file could not be written or read back
+int exportTimeline(struct Timeline *timeline, FILE *file, int iCpus) {
+    struct Writer *writer = init_writer(file);
+    size_t iRead;
+    int iFailed;
+
+    timelineSpill(timeline);
+    writeText(writer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    writeText(writer, "{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"sched\"}}");
+    for (int i = 0;i <= iCpus;i++) {
+        if (writer->used + 256 > WRITE_BLOCK) {
+            writerFlush(writer);
+        }
+        writeText(writer, ",\n{\"ph\":\"M\",\"pid\":0,\"tid\":");
+        writeInt(writer, i);
+        if (i < iCpus) {
+            writeText(writer, ",\"name\":\"thread_name\",\"args\":{\"name\":\"CPU ");
+            writeInt(writer, i);
+            writeText(writer, "\"}}");
+        } else {
+            writeText(writer, ",\"name\":\"thread_name\",\"args\":{\"name\":\"Arrivals\"}}");
+        }
+    }
+    //  the block is free once spilled, so the log is read back through it
+    if (fflush(timeline->log) != 0 || fseek(timeline->log, 0, SEEK_SET) != 0) {
+        timeline->failed = 1;
+    }
+    while (!timeline->failed && (iRead = fread(timeline->events, sizeof(struct Event), TIMELINE_BLOCK, timeline->log)) > 0) {
+        for (size_t i = 0;i < iRead;i++) {
+            writeEvent(writer, &timeline->events[i], iCpus);
+        }
+    }
+    if (ferror(timeline->log)) {
+        timeline->failed = 1;
+    }
+    writeText(writer, "\n]}\n");
+    iFailed = del_writer(writer);
+    return (iFailed != 0 || timeline->failed) ? -1 : 0;
+}
+
+//------------------------------------------------------------------------------
+//  Sorting Methods
+//------------------------------------------------------------------------------
+//  how many of the n values from the start never decrease, checked on from
+//  the i already known to
+int sortedPrefixScalar(const int *values, int i, int n) {
+    for (;i + 1 < n;i++) {
+        if (values[i] > values[i + 1]) { return i + 1; }
+    }
+    return (n > 0) ? n : 0;
+}
+
+//  the vector kernels each stop at the first stretch that decreases anywhere,
+//  leaving the scalar loop to find exactly where
+#ifdef SCHED_AVX2
+__attribute__((target("avx2"))) int sortedPrefixAvx2(const int *values, int n) {
+    __m256i descents;
+    int i = 0;
+    for (;i + 16 < n;i += 16) {
+        descents = _mm256_or_si256(
+            _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(values + i)), _mm256_loadu_si256((const __m256i *)(values + i + 1))),
+            _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(values + i + 8)), _mm256_loadu_si256((const __m256i *)(values + i + 9))));
+        if (!_mm256_testz_si256(descents, descents)) { break; }
+    }
+    return i;
+}
+#endif
+
+#ifdef SCHED_NEON
+int sortedPrefixNeon(const int *values, int n) {
+    uint32x4_t descents;
+    int i = 0;
+    for (;i + 8 < n;i += 8) {
+        descents = vorrq_u32(vcgtq_s32(vld1q_s32(values + i), vld1q_s32(values + i + 1)),
+            vcgtq_s32(vld1q_s32(values + i + 4), vld1q_s32(values + i + 5)));
+        if (vmaxvq_u32(descents) != 0) { break; }
+    }
+    return i;
+}
+#endif
+
+int sortedPrefix(const int *values, int n) {
+    int i = 0;
+#if defined(SCHED_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        i = sortedPrefixAvx2(values, n);
+    }
+#elif defined(SCHED_NEON)
+    i = sortedPrefixNeon(values, n);
+#endif
+    return sortedPrefixScalar(values, i, n);
+}
+
+//  merges runs a and b into out by arrival, taking from a on ties
+void mergeRuns(const int *arrival, const int *a, int na, const int *b, int nb, int *out) {
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    while (i < na && j < nb) {
+        if (arrival[a[i]] <= arrival[b[j]]) {
+            out[k++] = a[i++];
+        } else {
+            out[k++] = b[j++];
+        }
+    }
+    while (i < na) { out[k++] = a[i++]; }
+    while (j < nb) { out[k++] = b[j++]; }
+}
+
+//    stable bottom-up merge sort of n items by arrival, so ties keep their FCFS
+//    input order, using dst as scratch; returns whichever of the two holds
+//    them sorted
+int *sortRun(const int *arrival, int *src, int *dst, int n) {
+    int *tmp;
+    int iMid, iEnd;
+
+    for (int width = 1;width < n;width *= 2) {
+        for (int iStart = 0;iStart < n;iStart += 2 * width) {
+            iMid = (iStart + width < n) ? iStart + width : n;
+            iEnd = (iStart + 2 * width < n) ? iStart + 2 * width : n;
+            mergeRuns(arrival, src + iStart, iMid - iStart, src + iMid, iEnd - iMid, dst + iStart);
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    return src;
+}
+
+//  how many of the first k items merging a and b gives come from a, found by
+//  bisection so that a merge can be cut anywhere and its slices done apart
+int mergeSplit(const int *arrival, const int *a, int na, const int *b, int nb, int k) {
+    int iLow = (k > nb) ? k - nb : 0;
+    int iHigh = (k < na) ? k : na;
+    int i;
+    while (iLow < iHigh) {
+        i = (iLow + iHigh) / 2;
+        //  a[i] goes out before b[k - i - 1], so more than i come from a
+        if (arrival[a[i]] <= arrival[b[k - i - 1]]) {
+            iLow = i + 1;
+        } else {
+            iHigh = i;
+        }
+    }
+    return iLow;
+}
+
+//  sorts runs or merges slices of a round until none are left; every run is
+//  left sorted in src, and every round merges src into dst
+void *sortWorker(void *arg) {
+    struct Sort *sort = arg;
+    int iTask;
+    int n = sort->n;
+    int iWidth = sort->iWidth;
+    int iFirst, iLast, iLow, iMid, iHigh, iFrom, iTo, iA, iB;
+
+    while ((iTask = takeTask(&sort->tasks)) != -1) {
+        if (iWidth == 0) {
+            iFirst = iTask * sort->iRun;
+            iLast = (n - iFirst > sort->iRun) ? iFirst + sort->iRun : n;
+            if (sortRun(sort->arrival, sort->src + iFirst, sort->dst + iFirst, iLast - iFirst) != sort->src + iFirst) {
+                memcpy(sort->src + iFirst, sort->dst + iFirst, (size_t)(iLast - iFirst) * sizeof(int));
+            }
+            continue;
+        }
+        iFirst = (int)((long long)n * iTask / sort->tasks.count);
+        iLast = (int)((long long)n * (iTask + 1) / sort->tasks.count);
+        //  the slice from iFirst to iLast of the output may span several
+        //  pairs of runs, each merged only as far as it falls in the slice
+        for (iLow = iFirst - iFirst % (2 * iWidth);iLow < iLast;iLow += 2 * iWidth) {
+            iMid = (iLow + iWidth < n) ? iLow + iWidth : n;
+            iHigh = (iLow + 2 * iWidth < n) ? iLow + 2 * iWidth : n;
+            iFrom = ((iFirst > iLow) ? iFirst : iLow) - iLow;
+            iTo = ((iLast < iHigh) ? iLast : iHigh) - iLow;
+            iA = mergeSplit(sort->arrival, sort->src + iLow, iMid - iLow, sort->src + iMid, iHigh - iMid, iFrom);
+            iB = mergeSplit(sort->arrival, sort->src + iLow, iMid - iLow, sort->src + iMid, iHigh - iMid, iTo);
+            mergeRuns(sort->arrival, sort->src + iLow + iA, iB - iA, sort->src + iMid + iFrom - iA, (iTo - iB) - (iFrom - iA),
+                sort->dst + iLow + iFrom);
+        }
+    }
+    return NULL;
+}
+
+//  stable sort of a freshly filled queue by arrival, on iThreads threads when
+//  it is large enough to share out: a run each, then merges of pairs of runs,
+//  every round of which is cut evenly between them however long its runs
+void sortArrival(struct ProcessTable *table, struct Arena *arena, struct IndexQueue *queue, int iThreads) {
+    struct Sort sort;
+    int *tmp;
+    int n = queue->count;
+
+    sort.arrival = table->arrival;
+    sort.src = queue->items;
+    sort.dst = arenaAlloc(arena, queue->capacity * sizeof(int));
+    sort.n = n;
+    iThreads = threadCount(iThreads);
+    if (iThreads > n / SORT_BLOCK) {
+        iThreads = n / SORT_BLOCK;
+    }
+    if (iThreads < 2) {
+        queue->items = sortRun(sort.arrival, sort.src, sort.dst, n);
+        queue->head = 0;
+        return;
+    }
+    sort.iRun = (n + iThreads - 1) / iThreads;
+    sort.tasks.count = (n + sort.iRun - 1) / sort.iRun;
+    sort.iWidth = 0;
+    runWorkers(sortWorker, &sort.tasks, &sort, iThreads);
+    sort.tasks.count = iThreads;
+    for (int iWidth = sort.iRun;iWidth < n;iWidth *= 2) {
+        sort.iWidth = iWidth;
+        runWorkers(sortWorker, &sort.tasks, &sort, iThreads);
+        tmp = sort.src;
+        sort.src = sort.dst;
+        sort.dst = tmp;
+    }
+    queue->items = sort.src;
+    queue->head = 0;
+}
+
+//    the processes after the first in stable arrival order, taken straight
+//    from a binary trace when it stores one
+struct IndexQueue *init_job_queue(struct ProcessTable *table, struct Arena *arena, int iThreads) {
+    struct IndexQueue *JobQueue;
+    if (table->order != NULL) {
+        JobQueue = arenaAlloc(arena, sizeof(struct IndexQueue));
+        JobQueue->items = table->order;
+        JobQueue->head = 0;
+        JobQueue->count = (table->count > 0) ? table->count - 1 : 0;
+        //  never refilled, so only the mask needs to cover the count
+        JobQueue->capacity = 16;
+        while (JobQueue->capacity < table->count) {
+            JobQueue->capacity <<= 1;
+        }
+        return JobQueue;
+    }
+    JobQueue = init_queue(arena, table->count);
+    for (int i = 1;i < table->count;i++) {
+        enqueue(JobQueue, i);
+    }
+    //  an input already in arrival order, as most are, needs no sorting
+    if (sortedPrefix(table->arrival + 1, table->count - 1) < table->count - 1) {
+        sortArrival(table, arena, JobQueue, iThreads);
+    }
+    return JobQueue;
+}
+
+//------------------------------------------------------------------------------
+//  Engine Methods
+//------------------------------------------------------------------------------
+//  a run over a loaded table, whose queues are all sized to it
+struct Engine *init_engine(struct ProcessTable *table, struct Arena *arena) {
+    struct Engine *newEngine = arenaAlloc(arena, sizeof(struct Engine));
+    memset(newEngine, 0, sizeof(struct Engine));
+    newEngine->table = table;
+    newEngine->arena = arena;
+    newEngine->JobQueue = init_job_queue(table, arena, 1);
+    newEngine->ReadyQueue = init_queue(arena, table->count);
+    newEngine->ProcessQueue = init_queue(arena, table->count);
+    newEngine->stats = init_stats(arena);
+    return newEngine;
+}
+
+//  a run that reads its processes from reader as it goes, at most iLimit of
+//  them when iLimit > 0, and writes each result to writer as it finishes
+struct Engine *init_stream(struct Arena *arena, struct TraceReader *reader, struct Writer *writer, int iBinary, int iLimit) {
+    struct Engine *newEngine = arenaAlloc(arena, sizeof(struct Engine));
+    memset(newEngine, 0, sizeof(struct Engine));
+    newEngine->table = init_table();
+    newEngine->arena = arena;
+    newEngine->ReadyQueue = init_queue(arena, 1024);
+    newEngine->FreeRows = init_queue(arena, 1024);
+    newEngine->reader = reader;
+    newEngine->writer = writer;
+    newEngine->iBinary = iBinary;
+    newEngine->iLimit = iLimit;
+    newEngine->stats = init_stats(arena);
+    newEngine->iLookahead = 1;
+    readAhead(newEngine);
+    return newEngine;
+}
+
+//  reads the process after the lookahead into engine->next, or leaves nothing
+//  pending at the limit, the end of the trace or a bad line
+void readAhead(struct Engine *engine) {
+    int iPrevArrival = engine->next[1];
+    int iRead;
+
+    engine->pending = 0;
+    //  a live engine's were checked for order as they were submitted
+    if (engine->live != NULL) {
+        if (engine->live->Inbox->count > 0) {
+            for (int i = 0;i < 4;i++) {
+                engine->next[i] = dequeue(engine->live->Inbox);
+            }
+            engine->pending = 1;
+        }
+        return;
+    }
+    if (engine->lMalformed > 0 || engine->lUnsorted > 0 || engine->lNegative > 0) { return; }
+    if (engine->iLimit > 0 && engine->iRead >= engine->iLimit) { return; }
+    iRead = readProcess(engine->reader, engine->next);
+    if (iRead < 0) {
+        engine->lMalformed = engine->reader->lLine;
+        return;
+    }
+    if (iRead == 0) { return; }
+    if (engine->next[2] < 0) {
+        engine->lNegative = engine->reader->lLine;
+        return;
+    }
+    engine->iRead++;
+    //  the first process is dispatched at once, so order only matters after it
+    if (engine->iRead > 2 && engine->next[1] < iPrevArrival) {
+        engine->lUnsorted = engine->reader->lLine;
+        return;
+    }
+    engine->pending = 1;
+}
+
+//  gives the lookahead process a row, reusing a finished one where possible
+int admitStreamed(struct Engine *engine) {
+    int *next = engine->next;
+    int iRow = dequeue(engine->FreeRows);
+    if (iRow == -1) {
+        iRow = tableAppend(engine->table, next[0], next[1], next[2], next[3]);
+    } else {
+        tableFill(engine->table, iRow, next[0], next[1], next[2], next[3]);
+    }
+    readAhead(engine);
+    return iRow;
+}
+
+//  the process dispatched at CLOCK 0, which is always the first one given
+int firstProcess(struct Engine *engine) {
+    int iFirst;
+    if (engine->iLookahead) {
+        iFirst = engine->pending ? admitStreamed(engine) : -1;
+    } else {
+        iFirst = (engine->table->count > 0) ? 0 : -1;
+    }
+    if (iFirst != -1) {
+        logEvent(engine, EVENT_ARRIVAL, -1, engine->table->pid[iFirst], engine->table->arrival[iFirst], engine->table->arrival[iFirst]);
+    }
+    return iFirst;
+}
+
+//  records a completion at CLOCK, then queues the process for printing or,
+//  when streaming, writes it out and frees its row
+void finishProcess(struct Engine *engine, int index, long long CLOCK) {
+    struct ProcessTable *table = engine->table;
+    struct Stats *stats = engine->stats;
+    table->waiting[index] = CLOCK - table->arrival[index] - table->burst[index];
+    table->finish[index] = CLOCK;
+    engine->completed++;
+    //  a row about to be reused counts towards the totals now, while a table
+    //  kept whole is summed by sumTotals() at the end
+    if (engine->writer != NULL || engine->live != NULL) {
+        engine->llWait += table->waiting[index];
+        engine->llTurnover += table->finish[index] - table->arrival[index];
+    }
+    histogramRecord(&stats->Wait, table->waiting[index]);
+    histogramRecord(&stats->Turnover, table->finish[index] - table->arrival[index]);
+    histogramRecord(&stats->Response, table->started[index] - table->arrival[index]);
+    stats->llResponse += table->started[index] - table->arrival[index];
+    stats->llBusy += (table->burst[index] > 0) ? table->burst[index] : 0;
+    if (engine->writer != NULL) {
+        writeResult(engine->writer, engine->iBinary, table->pid[index], table->arrival[index], table->finish[index], table->waiting[index],
+            engine->iSwitching ? table->preemptions[index] : -1);
+        enqueue(engine->FreeRows, index);
+    } else if (engine->live != NULL) {
+        if (engine->live->callback != NULL) {
+            struct SchedResult result = {table->pid[index], table->arrival[index], table->finish[index], table->waiting[index], table->preemptions[index]};
+            engine->live->callback(engine->live->context, &result);
+        }
+        enqueue(engine->FreeRows, index);
+    } else {
+        enqueue(engine->ProcessQueue, index);
+    }
+}
+
+//  notes the CLOCK a process first gets a CPU, from which its response time
+//  is measured
+void startProcess(struct Engine *engine, int index, long long CLOCK) {
+    if (engine->table->started[index] == -1) {
+        engine->table->started[index] = CLOCK;
+    }
+}
+
+//------------------------------------------------------------------------------
+//  Scheduling Methods
+//------------------------------------------------------------------------------
+//  hands a newly admitted process to the policy, on more than one CPU by way
+//  of the idle CPU that will take it, or else the next CPU in turn. On one
+//  CPU, every unfinished process but the one running is ready
+void admitReady(struct Engine *engine, int index) {
+    struct Stats *stats = engine->stats;
+    long long llReady;
+    logEvent(engine, EVENT_ARRIVAL, -1, engine->table->pid[index], engine->table->arrival[index], engine->table->arrival[index]);
+    stats->llAdmitted++;
+    if (engine->cpus != NULL) {
+        if (!engine->iGlobal) {
+            if (engine->iIdle > 0) {
+                serveCpu(engine, &engine->cpus[engine->Idle[engine->iIdle - 1]]);
+            } else {
+                serveCpu(engine, &engine->cpus[engine->iPlace]);
+                engine->iPlace = (engine->iPlace + 1) % engine->iCpus;
+            }
+            engine->cpus[engine->iServing].quiet = -1;
+            engine->cpus[engine->iServing].drained = -1;
+        }
+        engine->iReady++;
+    }
+    llReady = (engine->cpus != NULL) ? engine->iReady : stats->llAdmitted - engine->completed;
+    if (llReady > stats->llMaxReady) {
+        stats->llMaxReady = llReady;
+    }
+    engine->policy->onArrival(engine, index);
+}
+
+//  the JobQueue (or the sorted stream) acts as a cursor: arrivals at CLOCK are
+//  admitted in input order, and anything left behind the cursor missed every
+//  check and can never be admitted
+void arrivalChecker(struct Engine *engine, long long CLOCK) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *JobQueue = engine->JobQueue;
+    engine->llClock = CLOCK;
+    if (engine->iLookahead) {
+        while (engine->pending && engine->next[1] < CLOCK) {
+            readAhead(engine);
+        }
+        while (engine->pending && engine->next[1] == CLOCK) {
+            admitReady(engine, admitStreamed(engine));
+        }
+        return;
+    }
+    while (JobQueue->count > 0 && table->arrival[JobQueue->items[JobQueue->head]] < CLOCK) {
+        dequeue(JobQueue);
+    }
+    while (JobQueue->count > 0 && table->arrival[JobQueue->items[JobQueue->head]] == CLOCK) {
+        admitReady(engine, dequeue(JobQueue));
+    }
+}
+
+//  earliest arrival on the JobQueue after CLOCK, or -1 if none
+LOOP_INLINE long long tableNextArrival(struct Engine *engine, long long CLOCK) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *JobQueue = engine->JobQueue;
+    //  the JobQueue is never refilled, so its items run straight from head
+    for (int i = JobQueue->head;i < JobQueue->head + JobQueue->count;i++) {
+        if (table->arrival[JobQueue->items[i]] > CLOCK) {
+            return table->arrival[JobQueue->items[i]];
+        }
+    }
+    return -1;
+}
+
+//  earliest arrival still waiting after CLOCK, or -1 if none
+long long nextArrival(struct Engine *engine, long long CLOCK) {
+    if (engine->iLookahead) {
+        //  a stream cannot look past its lookahead, but if that arrived by
+        //  CLOCK a check at CLOCK + 1, a tick the clock passes anyway, drops it.
+        //  A live engine with nothing submitted may yet be given an arrival
+        //  just past its horizon
+        if (!engine->pending) {
+            if (engine->live != NULL && engine->live->llHorizon < LLONG_MAX) {
+                return engine->live->llHorizon + 1;
+            }
+            return -1;
+        }
+        return (engine->next[1] > CLOCK) ? engine->next[1] : CLOCK + 1;
+    }
+    return tableNextArrival(engine, CLOCK);
+}
+
+//  the CPU moves from previous (a row if it was preempted, or -2 if it
+//  finished) to another process at CLOCK, which takes engine->iSwitch ms, with
+//  the arrivals up to the end of it admitted; returns the CLOCK the process
+//  starts at
+long long contextSwitch(struct Engine *engine, int previous, long long CLOCK) {
+    long long llEnd = CLOCK + engine->iSwitch;
+    long long llArrival;
+    if (engine->iSwitch > 0) {
+        logEvent(engine, EVENT_SWITCH, 0, (previous >= 0) ? engine->table->pid[previous] : -1, CLOCK, llEnd);
+    }
+    if (previous >= 0) {
+        engine->table->preemptions[previous]++;
+    }
+    engine->llSwitches++;
+    engine->llSwitchTime += engine->iSwitch;
+    while ((llArrival = nextArrival(engine, CLOCK)) != -1 && llArrival <= llEnd) {
+        CLOCK = llArrival;
+        arrivalChecker(engine, CLOCK);
+    }
+    //  the end of the switch is checked too, so an MLFQ boost due by then is
+    //  seen by whatever is picked next
+    arrivalChecker(engine, llEnd);
+    return llEnd;
+}
+
+//  admitReady() for a plain loop, with no timeline to log to and no CPUs to
+//  place the process on
+LOOP_INLINE void loopAdmit(struct Engine *engine, const int iLoop, int index) {
+    struct Stats *stats = engine->stats;
+    long long llReady;
+    stats->llAdmitted++;
+    llReady = stats->llAdmitted - engine->completed;
+    if (llReady > stats->llMaxReady) {
+        stats->llMaxReady = llReady;
+    }
+    if (iLoop == LOOP_RR || iLoop == LOOP_FCFS) {
+        enqueue(engine->ReadyQueue, index);
+    } else if (iLoop == LOOP_NPP) {
+        heapPush(engine->ReadyHeap, index, engine->table->priority[index]);
+    } else {
+        heapPush(engine->ReadyHeap, index, engine->table->burst[index]);
+    }
+}
+
+//  arrivalChecker() for the loop, a plain one only ever reading the JobQueue
+LOOP_INLINE void loopArrivals(struct Engine *engine, const int iLoop, long long CLOCK) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *JobQueue = engine->JobQueue;
+    if (iLoop == LOOP_HOOKS) {
+        arrivalChecker(engine, CLOCK);
+        return;
+    }
+    engine->llClock = CLOCK;
+    while (JobQueue->count > 0 && table->arrival[JobQueue->items[JobQueue->head]] < CLOCK) {
+        dequeue(JobQueue);
+    }
+    while (JobQueue->count > 0 && table->arrival[JobQueue->items[JobQueue->head]] == CLOCK) {
+        loopAdmit(engine, iLoop, dequeue(JobQueue));
+    }
+}
+
+LOOP_INLINE long long loopNextArrival(struct Engine *engine, const int iLoop, long long CLOCK) {
+    return (iLoop == LOOP_HOOKS) ? nextArrival(engine, CLOCK) : tableNextArrival(engine, CLOCK);
+}
+
+LOOP_INLINE int loopSelect(struct Engine *engine, const int iLoop) {
+    if (iLoop == LOOP_RR || iLoop == LOOP_FCFS) { return dequeue(engine->ReadyQueue); }
+    if (iLoop == LOOP_NPP || iLoop == LOOP_SJF) { return heapPop(engine->ReadyHeap); }
+    return engine->policy->selectNext(engine);
+}
+
+//  the CLOCK jumps from event to event (arrival, completion or the end of a
+//  slice) rather than ticking through every millisecond of a burst, and the
+//  engine's policy is only consulted at those events. A live engine stops
+//  short of any event past its horizon, to pick up from there once advanced.
+//  iLoop is always a constant, one of the LOOP_ variants
+LOOP_INLINE void scheduleLoop(struct Engine *engine, const int iLoop) {
+    struct ProcessTable *table = engine->table;
+    struct Policy *policy = engine->policy;
+    struct Live *live = (iLoop == LOOP_HOOKS) ? engine->live : NULL;
+    long long llHorizon = (live != NULL) ? live->llHorizon : LLONG_MAX;
+    long long CLOCK = 0;
+    long long llEvent = 0;
+    long long llArrival;
+    long long llStart = 0;
+    long long llDispatch = 0;
+    int iCurrent;
+    int iPrevious = -1;
+    int iFinished;
+    int iSlice;
+    int iCompleting = 0;
+    int iPreempted;
+    int iRunning = 0;
+    if (live == NULL) {
+        //  the first process is dispatched at once; the rest wait for the clock
+        iCurrent = firstProcess(engine);
+    } else {
+        CLOCK = live->CLOCK;
+        iCurrent = live->iCurrent;
+        iPrevious = live->iPrevious;
+        iRunning = live->iRunning;
+        iCompleting = live->iCompleting;
+        llDispatch = live->llDispatch;
+        llStart = live->llStart;
+        llEvent = live->llEvent;
+    }
+    while (1) {
+        //  a run ends at the first idle moment, but a live engine waits for
+        //  the next arrival
+        if (iCurrent == -1) {
+            llArrival = (live != NULL) ? nextArrival(engine, CLOCK) : -1;
+            if (llArrival == -1 || llArrival > llHorizon) { break; }
+            CLOCK = llArrival;
+            loopArrivals(engine, iLoop, CLOCK);
+            if (iPrevious != -1) { iPrevious = -2; }
+            iCurrent = loopSelect(engine, iLoop);
+            continue;
+        }
+        if (!iRunning) {
+            //  a switch is only begun once every arrival during it is known
+            if (iPrevious != -1 && iCurrent != iPrevious && CLOCK + engine->iSwitch > llHorizon) { break; }
+            engine->llEvents++;
+            //  nothing is switched when a process is put straight back on the CPU
+            if (iPrevious != -1 && iCurrent != iPrevious && iLoop != LOOP_HOOKS) {
+                //  a free switch without a timeline only needs counting
+                if (iPrevious >= 0) {
+                    table->preemptions[iPrevious]++;
+                }
+                engine->llSwitches++;
+            } else if (iPrevious != -1 && iCurrent != iPrevious) {
+                CLOCK = contextSwitch(engine, iPrevious, CLOCK);
+                //  an arrival during the switch may already outrank the process
+                if (policy->preempts != NULL && engine->iSwitch > 0 && policy->preempts(engine, iCurrent)) {
+                    iPrevious = iCurrent;
+                    iCurrent = policy->selectNext(engine);
+                    continue;
+                }
+            }
+            iPrevious = iCurrent;
+            startProcess(engine, iCurrent, CLOCK);
+            if (iLoop == LOOP_RR || (iLoop == LOOP_HOOKS && policy->forward != NULL)) {
+                iFinished = engine->completed;
+                CLOCK = (iLoop == LOOP_RR) ? rrForward(engine, &iCurrent, CLOCK) : policy->forward(engine, &iCurrent, CLOCK);
+                if (iCurrent == -1) { continue; }
+                //  the processes it finished have all been accounted for
+                if (engine->completed != iFinished) {
+                    iPrevious = -2;
+                    continue;
+                }
+            }
+            if (iLoop == LOOP_RR) {
+                iSlice = engine->iQuantum;
+            } else if (iLoop == LOOP_HOOKS) {
+                iSlice = (policy->slice != NULL) ? policy->slice(engine, iCurrent) : INT_MAX;
+            } else {
+                iSlice = INT_MAX;
+            }
+            iCompleting = (table->leftover[iCurrent] <= iSlice);
+            llDispatch = CLOCK;
+            llEvent = CLOCK;
+            if (!iCompleting) {
+                llEvent += iSlice;
+            } else if (table->leftover[iCurrent] > 0) {
+                llEvent += table->leftover[iCurrent];
+            }
+            llStart = CLOCK;
+        }
+        iRunning = 0;
+        //  arrivals at the instant a process completes are admitted before it
+        //  does, while those at the instant its slice expires go behind it
+        iPreempted = 0;
+        while ((llArrival = loopNextArrival(engine, iLoop, CLOCK)) != -1 && (llArrival < llEvent || (iCompleting && llArrival == llEvent))) {
+            if (llArrival > llHorizon) { break; }
+            CLOCK = llArrival;
+            loopArrivals(engine, iLoop, CLOCK);
+            //  a preemptive policy may take the CPU back at any arrival
+            if (iLoop == LOOP_HOOKS && policy->preempts != NULL && CLOCK < llEvent) {
+                table->leftover[iCurrent] -= (int)(CLOCK - llStart);
+                llStart = CLOCK;
+                if (policy->preempts(engine, iCurrent)) {
+                    iPreempted = 1;
+                    break;
+                }
+            }
+        }
+        if (iPreempted) {
+            logEvent(engine, EVENT_SLICE, 0, table->pid[iCurrent], llDispatch, CLOCK);
+            iCurrent = policy->selectNext(engine);
+            continue;
+        }
+        if (llEvent > llHorizon) {
+            iRunning = 1;
+            break;
+        }
+        CLOCK = llEvent;
+        if (iLoop == LOOP_HOOKS) {
+            logEvent(engine, iCompleting ? EVENT_FINISH : EVENT_SLICE, 0, table->pid[iCurrent], llDispatch, CLOCK);
+        }
+        if (iCompleting) {
+            iPrevious = -2;
+            table->leftover[iCurrent] = 0;
+            finishProcess(engine, iCurrent, CLOCK);
+            if (iLoop == LOOP_HOOKS && policy->onComplete != NULL) {
+                policy->onComplete(engine, iCurrent);
+            }
+        } else {
+            table->leftover[iCurrent] -= (int)(llEvent - llStart);
+            if (iLoop == LOOP_RR) {
+                enqueue(engine->ReadyQueue, iCurrent);
+            } else {
+                policy->onQuantum(engine, iCurrent);
+            }
+        }
+        loopArrivals(engine, iLoop, CLOCK);
+        iCurrent = loopSelect(engine, iLoop);
+    }
+    engine->llEnd = CLOCK;
+    if (live != NULL) {
+        live->CLOCK = CLOCK;
+        live->iCurrent = iCurrent;
+        live->iPrevious = iPrevious;
+        live->iRunning = iRunning;
+        live->iCompleting = iCompleting;
+        live->llDispatch = llDispatch;
+        live->llStart = llStart;
+        live->llEvent = llEvent;
+    }
+}
+
+void schedule(struct Engine *engine) {
+    scheduleLoop(engine, LOOP_HOOKS);
+}
+
+void scheduleNpp(struct Engine *engine) {
+    scheduleLoop(engine, LOOP_NPP);
+}
+
+void scheduleRr(struct Engine *engine) {
+    scheduleLoop(engine, LOOP_RR);
+}
+
+void scheduleFcfs(struct Engine *engine) {
+    scheduleLoop(engine, LOOP_FCFS);
+}
+
+void scheduleSjf(struct Engine *engine) {
+    scheduleLoop(engine, LOOP_SJF);
+}
+
+//  runs the engine under the named policy, or returns -1 if there is none
+int processQueue(struct Engine *engine, char *cAlgorithm, int iQuantum) {
+    struct Policy *policy = findPolicy(cAlgorithm);
+    if (policy == NULL) { return -1; }
+    engine->policy = policy;
+    engine->iQuantum = iQuantum;
+    if (engine->iCpus > 1) {
+        init_cpus(engine);
+        scheduleSMP(engine);
+    } else {
+        if (policy->init != NULL) {
+            policy->init(engine);
+        }
+        //  a plain run takes the loop specialised for its policy, if it has one
+        if (policy->plain != NULL && engine->timeline == NULL && engine->live == NULL && !engine->iLookahead && engine->iSwitch == 0) {
+            policy->plain(engine);
+        } else {
+            schedule(engine);
+        }
+    }
+    if (engine->writer == NULL && engine->live == NULL) {
+        sumTotals(engine);
+    }
+    return 0;
+}
+
+
+//------------------------------------------------------------------------------
+//  Multi-CPU Methods
+//------------------------------------------------------------------------------
+//  gives each CPU its ready structures: the engine's own under a global queue,
+//  or else a private set that starts small and grows with its share
+void init_cpus(struct Engine *engine) {
+    struct IndexQueue *ReadyQueue = engine->ReadyQueue;
+    struct Cpu *cpu;
+    engine->cpus = arenaAlloc(engine->arena, engine->iCpus * sizeof(struct Cpu));
+    engine->Idle = arenaAlloc(engine->arena, engine->iCpus * sizeof(int));
+    if (engine->iGlobal && engine->policy->init != NULL) {
+        engine->policy->init(engine);
+    }
+    for (int i = 0;i < engine->iCpus;i++) {
+        cpu = &engine->cpus[i];
+        memset(cpu, 0, sizeof(struct Cpu));
+        cpu->current = -1;
+        cpu->previous = -1;
+        cpu->quiet = -1;
+        cpu->drained = -1;
+        if (engine->iGlobal) {
+            cpu->ReadyQueue = ReadyQueue;
+            cpu->ReadyHeap = engine->ReadyHeap;
+        } else {
+            engine->ReadyQueue = init_queue(engine->arena, 1024);
+            if (engine->policy->init != NULL) {
+                engine->policy->init(engine);
+            }
+            cpu->ReadyQueue = engine->ReadyQueue;
+            cpu->ReadyHeap = engine->ReadyHeap;
+        }
+    }
+    //  CPU 0 on top, so it is the first to take work
+    for (int i = engine->iCpus - 1;i >= 0;i--) {
+        engine->Idle[engine->iIdle++] = i;
+    }
+}
+
+//  points the policy hooks at the ready structures of cpu
+void serveCpu(struct Engine *engine, struct Cpu *cpu) {
+    engine->ReadyQueue = cpu->ReadyQueue;
+    engine->ReadyHeap = cpu->ReadyHeap;
+    engine->iServing = (int)(cpu - engine->cpus);
+}
+
+//  the process cpu runs next: its own pick, or failing that the pick of the
+//  first CPU after it with one ready, stolen
+int takeReady(struct Engine *engine, struct Cpu *cpu) {
+    int iSelf = (int)(cpu - engine->cpus);
+    int iIndex;
+    serveCpu(engine, cpu);
+    iIndex = engine->policy->selectNext(engine);
+    if (iIndex != -1 || engine->iGlobal) { return iIndex; }
+    for (int i = 1;i < engine->iCpus;i++) {
+        serveCpu(engine, &engine->cpus[(iSelf + i) % engine->iCpus]);
+        iIndex = engine->policy->selectNext(engine);
+        if (iIndex != -1) {
+            cpu->steals++;
+            cpu->quiet = -1;
+            cpu->drained = -1;
+            engine->cpus[(iSelf + i) % engine->iCpus].quiet = -1;
+            engine->cpus[(iSelf + i) % engine->iCpus].drained = -1;
+            return iIndex;
+        }
+    }
+    return -1;
+}
+
+//  works out cpu->quiet and cpu->drained for the ring cpu is running, unless
+//  they still stand from when it last had the same members. Until it gains or
+//  loses one, every process on it takes a whole quantum each round, so the one
+//  needing the fewest more quanta, c, cannot finish before c - 1 more rounds
+//  of them all; nor can the ring run out before it has run all its time left
+void quietUntil(struct Engine *engine, struct Cpu *cpu) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *ReadyQueue = cpu->ReadyQueue;
+    int iQuantum = engine->iQuantum;
+    int iLeast;
+    int iLeft;
+    int iQuanta;
+    long long llLeft;
+    if (cpu->quiet != -1) { return; }
+    iLeft = table->leftover[cpu->current] - cpu->slice;
+    iLeast = (iLeft > 0) ? (iLeft - 1) / iQuantum + 1 : 0;
+    llLeft = (iLeft > 0) ? iLeft : 0;
+    for (int i = 0;i < ReadyQueue->count;i++) {
+        iLeft = table->leftover[ReadyQueue->items[(ReadyQueue->head + i) & (ReadyQueue->capacity - 1)]];
+        iQuanta = (iLeft > 0) ? (iLeft - 1) / iQuantum + 1 : 0;
+        if (iQuanta < iLeast) {
+            iLeast = iQuanta;
+        }
+        llLeft += (iLeft > 0) ? iLeft : 0;
+    }
+    cpu->quiet = cpu->until;
+    if (cpu->completing) {
+        iLeast = 0;
+    } else if (iLeast > 1) {
+        cpu->quiet += (long long)(iLeast - 1) * (ReadyQueue->count + 1) * iQuantum;
+    }
+    if (cpu->drained == -1) {
+        cpu->drained = cpu->until + llLeft;
+    }
+}
+
+//  sets engine->llBarrier and engine->llSteal for the ring of cpu, dispatched
+//  at CLOCK: the next arrival, or else the first instant another CPU might
+//  finish a process, and so put it out of order, or run out of them and steal
+//  from the ring. Returns 0 if the ring may not be forwarded at all, while an
+//  idle CPU could steal from it at once
+int forwardBarrier(struct Engine *engine, struct Cpu *cpu, long long CLOCK) {
+    struct Cpu *other;
+    long long llArrival;
+    if (engine->policy->forward == NULL || engine->iGlobal || (engine->iIdle > 0 && engine->iReady > 0)) { return 0; }
+    llArrival = nextArrival(engine, CLOCK);
+    engine->llBarrier = llArrival;
+    engine->llSteal = llArrival;
+    for (int i = 0;i < engine->iCpus;i++) {
+        other = &engine->cpus[i];
+        if (other == cpu || other->current == -1) { continue; }
+        quietUntil(engine, other);
+        if (engine->llBarrier == -1 || other->quiet < engine->llBarrier) {
+            engine->llBarrier = other->quiet;
+        }
+        if (engine->llSteal == -1 || other->drained < engine->llSteal) {
+            engine->llSteal = other->drained;
+        }
+    }
+    return 1;
+}
+
+//  starts cpu on the process at index, after a context switch unless it is the
+//  one cpu last ran, scheduling the end of its slice. Where the policy can
+//  forward the ring of cpu up to the barrier, it does, and every process that
+//  finishes meanwhile is switched away from in turn
+void dispatchCpu(struct Engine *engine, struct Cpu *cpu, int index, long long CLOCK, struct Heap *Events) {
+    int iForward = forwardBarrier(engine, cpu, CLOCK);
+    long long llStart;
+    long long llSwitchTime;
+    int iFinished;
+    int iUntilScan;
+    int iLeft;
+    int iSlice;
+    while (1) {
+        if (cpu->previous != -1 && cpu->previous != index) {
+            if (engine->iSwitch > 0) {
+                logEvent(engine, EVENT_SWITCH, (int)(cpu - engine->cpus), (cpu->previous >= 0) ? engine->table->pid[cpu->previous] : -1,
+                    CLOCK, CLOCK + engine->iSwitch);
+            }
+            if (cpu->previous >= 0) {
+                engine->table->preemptions[cpu->previous]++;
+            }
+            engine->llSwitches++;
+            engine->llSwitchTime += engine->iSwitch;
+            CLOCK += engine->iSwitch;
+        }
+        cpu->previous = index;
+        cpu->current = index;
+        startProcess(engine, index, CLOCK);
+        if (!iForward || (engine->llSteal != -1 && engine->llSteal <= CLOCK)) { break; }
+        //  the ring is resolved with this CPU's own scratch and scan count
+        serveCpu(engine, cpu);
+        iUntilScan = engine->iUntilScan;
+        engine->iUntilScan = cpu->untilScan;
+        llStart = CLOCK;
+        llSwitchTime = engine->llSwitchTime;
+        iFinished = engine->completed;
+        CLOCK = engine->policy->forward(engine, &index, CLOCK);
+        cpu->untilScan = engine->iUntilScan;
+        engine->iUntilScan = iUntilScan;
+        cpu->llBusy += (CLOCK - llStart) - (engine->llSwitchTime - llSwitchTime);
+        cpu->current = index;
+        if (engine->completed == iFinished) { break; }
+        //  those finished were all on the ring, and its next is off the queue
+        engine->iReady -= engine->completed - iFinished;
+        cpu->quiet = -1;
+        cpu->previous = -2;
+    }
+    iLeft = engine->table->leftover[index];
+    iSlice = (engine->policy->slice != NULL) ? engine->policy->slice(engine, index) : INT_MAX;
+    cpu->completing = (iLeft <= iSlice);
+    if (cpu->completing) {
+        cpu->slice = (iLeft > 0) ? iLeft : 0;
+    } else {
+        cpu->slice = iSlice;
+    }
+    cpu->until = CLOCK + cpu->slice;
+    cpu->llBusy += cpu->slice;
+    //  slices ending together are taken in CPU order, however long ago each
+    //  was dispatched
+    Events->seq = (int)(cpu - engine->cpus);
+    heapPush(Events, (int)(cpu - engine->cpus), cpu->until);
+}
+
+//  hands ready processes to idle CPUs until either runs out
+void dispatchIdle(struct Engine *engine, struct Heap *Events, long long CLOCK) {
+    struct Cpu *cpu;
+    int iIndex;
+    while (engine->iIdle > 0 && engine->iReady > 0) {
+        cpu = &engine->cpus[engine->Idle[engine->iIdle - 1]];
+        iIndex = takeReady(engine, cpu);
+        if (iIndex == -1) { break; }
+        engine->iIdle--;
+        engine->iReady--;
+        dispatchCpu(engine, cpu, iIndex, CLOCK, Events);
+    }
+}
+
+//  as schedule(), over engine->iCpus CPUs whose slice ends wait on a heap. As
+//  on one CPU, the run ends the first moment every CPU is idle
+void scheduleSMP(struct Engine *engine) {
+    struct ProcessTable *table = engine->table;
+    struct Policy *policy = engine->policy;
+    struct Heap *Events = init_heap(engine->arena, engine->iCpus);
+    int *Ended = arenaAlloc(engine->arena, engine->iCpus * sizeof(int));
+    struct Cpu *cpu;
+    long long CLOCK = 0;
+    long long llArrival;
+    int iEnded;
+    int iIndex;
+
+    //  the first process is dispatched at once, on CPU 0
+    iIndex = firstProcess(engine);
+    if (iIndex == -1) { return; }
+    dispatchCpu(engine, &engine->cpus[engine->Idle[--engine->iIdle]], iIndex, CLOCK, Events);
+    while (engine->iIdle < engine->iCpus) {
+        engine->llEvents++;
+        llArrival = nextArrival(engine, CLOCK);
+        if (llArrival != -1 && llArrival < Events->entries[0].key) {
+            CLOCK = llArrival;
+            arrivalChecker(engine, CLOCK);
+            dispatchIdle(engine, Events, CLOCK);
+            continue;
+        }
+        //  of the slices ending now, the preempted go back first, then come
+        //  the arrivals of this instant, and then the finished are recorded
+        CLOCK = Events->entries[0].key;
+        iEnded = 0;
+        while (Events->count > 0 && Events->entries[0].key == CLOCK) {
+            cpu = &engine->cpus[heapPop(Events)];
+            Ended[iEnded++] = (int)(cpu - engine->cpus);
+            logEvent(engine, cpu->completing ? EVENT_FINISH : EVENT_SLICE, (int)(cpu - engine->cpus), table->pid[cpu->current],
+                cpu->until - cpu->slice, cpu->until);
+            if (!cpu->completing) {
+                table->leftover[cpu->current] -= cpu->slice;
+                serveCpu(engine, cpu);
+                policy->onQuantum(engine, cpu->current);
+                engine->iReady++;
+            }
+        }
+        arrivalChecker(engine, CLOCK);
+        for (int i = 0;i < iEnded;i++) {
+            cpu = &engine->cpus[Ended[i]];
+            if (cpu->completing) {
+                cpu->previous = -2;
+                cpu->quiet = -1;
+                table->leftover[cpu->current] = 0;
+                finishProcess(engine, cpu->current, CLOCK);
+                if (policy->onComplete != NULL) {
+                    policy->onComplete(engine, cpu->current);
+                }
+            }
+            cpu->current = -1;
+        }
+        //  the first of them to end is the first to take work again
+        for (int i = iEnded - 1;i >= 0;i--) {
+            engine->Idle[engine->iIdle++] = Ended[i];
+        }
+        dispatchIdle(engine, Events, CLOCK);
+        //  a preempted process taken by another CPU is switched out of its own
+        for (int i = 0;i < iEnded;i++) {
+            cpu = &engine->cpus[Ended[i]];
+            if (cpu->current == -1 && cpu->previous >= 0) {
+                table->preemptions[cpu->previous]++;
+                cpu->previous = -2;
+            }
+        }
+    }
+    engine->llEnd = CLOCK;
+}
+
+
+//------------------------------------------------------------------------------
+//  Policy Methods
+//------------------------------------------------------------------------------
+//  FIFO policies keep their ready processes on the ReadyQueue ring
+void fifoArrival(struct Engine *engine, int index) {
+    enqueue(engine->ReadyQueue, index);
+}
+
+int fifoSelect(struct Engine *engine) {
+    return dequeue(engine->ReadyQueue);
+}
+
+//  heap policies keep theirs on the ReadyHeap, ties going to the earliest
+//  admitted
+void heapInit(struct Engine *engine) {
+    engine->ReadyHeap = init_heap(engine->arena, engine->ReadyQueue->capacity);
+}
+
+int heapSelect(struct Engine *engine) {
+    return heapPop(engine->ReadyHeap);
+}
+
+void priorityArrival(struct Engine *engine, int index) {
+    heapPush(engine->ReadyHeap, index, engine->table->priority[index]);
+}
+
+void burstArrival(struct Engine *engine, int index) {
+    heapPush(engine->ReadyHeap, index, engine->table->burst[index]);
+}
+
+int rrSlice(struct Engine *engine, int index) {
+    (void)index;
+    return engine->iQuantum;
+}
+
+//  preemptive policies keep the running process on an indexed ReadyHeap as
+//  well, so that it can be re-keyed in place, and it gives way only to a
+//  process with a strictly smaller key
+void indexedInit(struct Engine *engine) {
+    engine->ReadyHeap = init_indexed_heap(engine->arena, engine->ReadyQueue->capacity, engine->table->capacity);
+}
+
+int heapFront(struct Engine *engine) {
+    return (engine->ReadyHeap->count > 0) ? engine->ReadyHeap->entries[0].index : -1;
+}
+
+void indexedComplete(struct Engine *engine, int index) {
+    if (heapHas(engine->ReadyHeap, index)) {
+        heapRemove(engine->ReadyHeap, index);
+    }
+}
+
+void leftoverArrival(struct Engine *engine, int index) {
+    heapPush(engine->ReadyHeap, index, engine->table->leftover[index]);
+}
+
+//  the process first dispatched never arrived through the policy, so it joins
+//  the heap at its first check
+int priorityPreempts(struct Engine *engine, int index) {
+    struct Heap *ReadyHeap = engine->ReadyHeap;
+    if (!heapHas(ReadyHeap, index)) {
+        heapPush(ReadyHeap, index, engine->table->priority[index]);
+    }
+    return ReadyHeap->entries[0].key < engine->table->priority[index];
+}
+
+//  the running process's key drops by the time it has run since last checked
+int leftoverPreempts(struct Engine *engine, int index) {
+    struct Heap *ReadyHeap = engine->ReadyHeap;
+    if (heapHas(ReadyHeap, index)) {
+        heapUpdate(ReadyHeap, index, engine->table->leftover[index]);
+    } else {
+        heapPush(ReadyHeap, index, engine->table->leftover[index]);
+    }
+    return ReadyHeap->entries[0].key < engine->table->leftover[index];
+}
+
+//  index of the lowest set bit of a non-zero mask
+int lowestBit(unsigned long long mask) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+//  iLevels levels (3 unless asked), level l with a quantum of q * 2^l, and a
+//  boost every 10 of the longest quanta unless asked; a boost of -1 never
+//  boosts at all
+void mlfqInit(struct Engine *engine) {
+    struct Mlfq *mlfq = arenaAlloc(engine->arena, sizeof(struct Mlfq));
+    long long llQuantum = engine->iQuantum;
+    memset(mlfq, 0, sizeof(struct Mlfq));
+    mlfq->count = (engine->iLevels > 0) ? engine->iLevels : 3;
+    mlfq->Levels = arenaAlloc(engine->arena, mlfq->count * sizeof(struct IndexQueue *));
+    mlfq->quantum = arenaAlloc(engine->arena, mlfq->count * sizeof(int));
+    for (int i = 0;i < mlfq->count;i++) {
+        mlfq->Levels[i] = init_queue(engine->arena, (i == 0) ? engine->ReadyQueue->capacity : 1024);
+        mlfq->quantum[i] = (int)((llQuantum < INT_MAX) ? llQuantum : INT_MAX);
+        llQuantum *= 2;
+    }
+    mlfq->rows = (engine->table->capacity > 0) ? engine->table->capacity : 1024;
+    mlfq->level = arenaAlloc(engine->arena, mlfq->rows * sizeof(int));
+    //  the first process is dispatched without arriving, at the top level
+    memset(mlfq->level, 0, mlfq->rows * sizeof(int));
+    if (engine->iBoost != 0) {
+        mlfq->boost = (engine->iBoost > 0) ? engine->iBoost : 0;
+    } else {
+        mlfq->boost = (int)((10LL * mlfq->quantum[mlfq->count - 1] < INT_MAX) ? 10LL * mlfq->quantum[mlfq->count - 1] : INT_MAX);
+    }
+    mlfq->nextBoost = mlfq->boost;
+    engine->mlfq = mlfq;
+}
+
+//  puts the process at the back of the ring of its level
+void mlfqQueue(struct Engine *engine, int index) {
+    struct Mlfq *mlfq = engine->mlfq;
+    enqueue(mlfq->Levels[mlfq->level[index]], index);
+    mlfq->mask |= 1ULL << mlfq->level[index];
+}
+
+//  new processes start at the top level
+void mlfqArrival(struct Engine *engine, int index) {
+    struct Mlfq *mlfq = engine->mlfq;
+    if (index >= mlfq->rows) {
+        int *level = arenaAlloc(engine->arena, 2 * (size_t)index * sizeof(int));
+        memcpy(level, mlfq->level, mlfq->rows * sizeof(int));
+        mlfq->level = level;
+        mlfq->rows = 2 * index;
+    }
+    mlfq->level[index] = 0;
+    mlfqQueue(engine, index);
+}
+
+//  the front of the highest non-empty level, once any boost that has come due
+//  has moved every ready process back to the top; nothing is running between
+//  dispatches, so a boost reaches every process not yet finished
+int mlfqSelect(struct Engine *engine) {
+    struct Mlfq *mlfq = engine->mlfq;
+    int iLevel;
+    int iIndex;
+    if (mlfq->boost > 0 && engine->llClock >= mlfq->nextBoost) {
+        for (int i = 1;i < mlfq->count;i++) {
+            while ((iIndex = dequeue(mlfq->Levels[i])) != -1) {
+                mlfq->level[iIndex] = 0;
+                enqueue(mlfq->Levels[0], iIndex);
+                mlfq->llPromotions++;
+            }
+        }
+        mlfq->mask = (mlfq->Levels[0]->count > 0) ? 1 : 0;
+        mlfq->nextBoost = (engine->llClock / mlfq->boost + 1) * mlfq->boost;
+    }
+    if (mlfq->mask == 0) { return -1; }
+    iLevel = lowestBit(mlfq->mask);
+    iIndex = dequeue(mlfq->Levels[iLevel]);
+    if (mlfq->Levels[iLevel]->count == 0) {
+        mlfq->mask &= ~(1ULL << iLevel);
+    }
+    return iIndex;
+}
+
+int mlfqSlice(struct Engine *engine, int index) {
+    return engine->mlfq->quantum[engine->mlfq->level[index]];
+}
+
+//  a process that used up its whole quantum drops a level, bar the last
+void mlfqQuantum(struct Engine *engine, int index) {
+    struct Mlfq *mlfq = engine->mlfq;
+    if (mlfq->level[index] < mlfq->count - 1) {
+        mlfq->level[index]++;
+        mlfq->llDemotions++;
+    }
+    mlfqQueue(engine, index);
+}
+
+//  an arrival at a higher level takes the CPU at once, and the process it
+//  interrupts keeps its level
+int mlfqPreempts(struct Engine *engine, int index) {
+    struct Mlfq *mlfq = engine->mlfq;
+    if (mlfq->mask & ((1ULL << mlfq->level[index]) - 1)) {
+        mlfqQueue(engine, index);
+        return 1;
+    }
+    return 0;
+}
+
+//  count of the items in the first i slots of a 1-based Fenwick tree
+int fenwickSum(int *tree, int i) {
+    int iSum = 0;
+    for (;i > 0;i -= i & -i) {
+        iSum += tree[i];
+    }
+    return iSum;
+}
+
+void fenwickAdd(int *tree, int n, int i, int delta) {
+    for (i++;i <= n;i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+//  resolves the stable stretch of the RR ring up to the next arrival in closed
+//  form, iCurrent having just been dispatched at CLOCK. A process needing c
+//  quanta finishes in round c, after every process that needs fewer and every
+//  one ahead of it in the ring that needs as many, so at
+//      CLOCK + (time of those) + its leftover + q * ((c - 1) * (others left)
+//                                             + (others left ahead of it))
+//  plus a context switch before each of the slices ahead of its last one.
+//  Completions are taken in that order until one would reach the arrival or
+//  leave a process alone on the ring, which then runs without switches, and
+//  the ring is rebuilt as it stands after the last of them. If none finish
+//  before it, whole rounds are skipped instead. A scan costs about as much as
+//  a round, so it is tried at most once a round. On more than one CPU, it
+//  resolves the ring of the CPU being served, finishing processes short of
+//  engine->llBarrier and skipping rounds short of engine->llSteal in place of
+//  the arrival. Returns the new CLOCK
+long long rrForward(struct Engine *engine, int *iCurrent, long long CLOCK) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *ReadyQueue = engine->ReadyQueue;
+    struct HeapEntry *top;
+    int *Members;
+    int iQuantum = engine->iQuantum;
+    int iSwitch = engine->iSwitch;
+    int iMembers = ReadyQueue->count + 1;
+    int iRemaining = iMembers;
+    int iLeast = -1;
+    int iLeft;
+    int iRounds;
+    int iPos;
+    int iLast = -1;
+    int iLastRounds = 0;
+    long long llDone = 0;
+    long long llSlices = 0;
+    long long llSwitched = 0;
+    long long llBefore;
+    long long llStart = CLOCK;
+    long long llFinish;
+    long long llFirst;
+    long long llRound;
+    long long llArrival;
+    long long llSteal;
+
+    if (iQuantum <= 0 || --engine->iUntilScan > 0) { return CLOCK; }
+    engine->iUntilScan = iMembers;
+    if (engine->iMembers < iMembers) {
+        engine->iMembers = ReadyQueue->capacity + 1;
+        engine->Members = arenaAlloc(engine->arena, engine->iMembers * sizeof(int));
+        engine->Tree = arenaAlloc(engine->arena, (engine->iMembers + 1) * sizeof(int));
+        engine->Starts = arenaAlloc(engine->arena, engine->iMembers * sizeof(long long));
+    }
+    Members = engine->Members;
+    Members[0] = *iCurrent;
+    for (int i = 1;i < iMembers;i++) {
+        Members[i] = ReadyQueue->items[(ReadyQueue->head + i - 1) & (ReadyQueue->capacity - 1)];
+    }
+    //  a process without time left finishes the moment it is dispatched. Each
+    //  is first dispatched in the first round, after a slice of each ahead of
+    //  it and a switch from each
+    llFirst = llStart;
+    for (int i = 0;i < iMembers;i++) {
+        iLeft = (table->leftover[Members[i]] > 0) ? table->leftover[Members[i]] : 0;
+        if (iLeast == -1 || iLeft < iLeast) {
+            iLeast = iLeft;
+        }
+        engine->Starts[i] = llFirst;
+        llFirst += ((iLeft < iQuantum) ? iLeft : iQuantum) + iSwitch;
+    }
+    //  whole rounds before the first completion, unless an arrival cuts in;
+    //  each slice of a round is followed by a switch unless the ring is alone
+    llRound = (iMembers > 1) ? (long long)iQuantum + iSwitch : iQuantum;
+    iRounds = (iLeast > 0) ? (iLeast - 1) / iQuantum : 0;
+    llArrival = nextArrival(engine, CLOCK);
+    llSteal = llArrival;
+    if (engine->cpus != NULL) {
+        llArrival = engine->llBarrier;
+        llSteal = engine->llSteal;
+    }
+    if (llSteal != -1 && (llSteal - CLOCK - 1) / (iMembers * llRound) < iRounds) {
+        iRounds = (int)((llSteal - CLOCK - 1) / (iMembers * llRound));
+    } else {
+        //  the first completion may come before the arrival, so resolve them
+        if (engine->Rounds == NULL) {
+            engine->Rounds = init_heap(engine->arena, ReadyQueue->capacity);
+        }
+        engine->Rounds->count = 0;
+        engine->Rounds->seq = 0;
+        //  pushed in ring order, so equal rounds pop ring position first
+        for (int i = 0;i < iMembers;i++) {
+            iLeft = (table->leftover[Members[i]] > 0) ? table->leftover[Members[i]] : 0;
+            //  one with no time left is still only reached in the first round
+            heapPush(engine->Rounds, i, (iLeft > 0) ? (iLeft - 1) / iQuantum + 1 : 1);
+            engine->Tree[i + 1] = (i + 1) & -(i + 1);
+        }
+        while (engine->Rounds->count > 0) {
+            top = &engine->Rounds->entries[0];
+            iPos = top->index;
+            if (iRemaining == 1) { break; }
+            iLeft = (table->leftover[Members[iPos]] > 0) ? table->leftover[Members[iPos]] : 0;
+            llBefore = (long long)(top->key - 1) * (iRemaining - 1) + fenwickSum(engine->Tree, iPos);
+            llFinish = llStart + llDone + iLeft + (long long)iQuantum * llBefore
+                + (long long)iSwitch * (llSlices + llBefore + top->key - 1);
+            if (llArrival != -1 && llFinish >= llArrival) { break; }
+            iLastRounds = (int)top->key;
+            heapPop(engine->Rounds);
+            llSwitched = llSlices + llBefore + iLastRounds - 1;
+            llDone += iLeft;
+            llSlices += iLastRounds;
+            table->preemptions[Members[iPos]] += iLastRounds - 1;
+            table->leftover[Members[iPos]] = 0;
+            logEvent(engine, EVENT_FINISH, engine->iServing, table->pid[Members[iPos]], llFinish - ((iLeft > 0) ? (iLeft - 1) % iQuantum + 1 : 0), llFinish);
+            startProcess(engine, Members[iPos], engine->Starts[iPos]);
+            finishProcess(engine, Members[iPos], llFinish);
+            Members[iPos] = -1;
+            fenwickAdd(engine->Tree, iMembers, iPos, -1);
+            iRemaining--;
+            iLast = iPos;
+            CLOCK = llFinish;
+        }
+    }
+
+    //  no completion: every process is simply iRounds quanta further on, and
+    //  unless it is alone has been switched out once a round
+    if (iLast == -1) {
+        for (int i = 0;i < iMembers;i++) {
+            table->leftover[Members[i]] -= iRounds * iQuantum;
+            if (iMembers > 1) {
+                table->preemptions[Members[i]] += iRounds;
+            }
+            if (iRounds > 0) {
+                startProcess(engine, Members[i], engine->Starts[i]);
+            }
+        }
+        if (iMembers > 1) {
+            engine->llSwitches += (long long)iRounds * iMembers;
+            engine->llSwitchTime += (long long)iRounds * iMembers * iSwitch;
+        }
+        if (iRounds > 0) {
+            logRounds(engine, engine->iServing, iMembers, iRounds, CLOCK, CLOCK + (long long)iRounds * iMembers * llRound);
+        }
+        return CLOCK + (long long)iRounds * iMembers * llRound;
+    }
+    //  the ring resumes just behind the last process to finish, with those
+    //  ahead of it served one round more than those after it, and switched
+    //  out after every slice
+    engine->llSwitches += llSwitched;
+    engine->llSwitchTime += llSwitched * iSwitch;
+    logRounds(engine, engine->iServing, iMembers, iLastRounds, llStart, CLOCK);
+    ReadyQueue->head = 0;
+    ReadyQueue->count = 0;
+    *iCurrent = -1;
+    for (int i = 1;i <= iMembers;i++) {
+        iPos = (iLast + i) % iMembers;
+        if (Members[iPos] == -1) { continue; }
+        iRounds = (iPos < iLast) ? iLastRounds : iLastRounds - 1;
+        table->leftover[Members[iPos]] -= iQuantum * iRounds;
+        table->preemptions[Members[iPos]] += iRounds;
+        if (iRounds > 0) {
+            startProcess(engine, Members[iPos], engine->Starts[iPos]);
+        }
+        if (*iCurrent == -1) {
+            *iCurrent = Members[iPos];
+        } else {
+            enqueue(ReadyQueue, Members[iPos]);
+        }
+    }
+    return CLOCK;
+}
+
+//  every policy processQueue() can run, by the name given on the command line;
+//  a policy without a slice runs each process to completion
+struct Policy Policies[] = {
+    {.cName = "NPP", .init = heapInit, .onArrival = priorityArrival, .selectNext = heapSelect, .plain = scheduleNpp},
+    {.cName = "RR", .iQuantum = 1, .onArrival = fifoArrival, .selectNext = fifoSelect,
+        .slice = rrSlice, .onQuantum = fifoArrival, .forward = rrForward, .plain = scheduleRr},
+    {.cName = "FCFS", .onArrival = fifoArrival, .selectNext = fifoSelect, .plain = scheduleFcfs},
+    {.cName = "SJF", .init = heapInit, .onArrival = burstArrival, .selectNext = heapSelect, .plain = scheduleSjf},
+    {.cName = "PP", .init = indexedInit, .onArrival = priorityArrival, .selectNext = heapFront,
+        .onComplete = indexedComplete, .preempts = priorityPreempts},
+    {.cName = "SRTF", .init = indexedInit, .onArrival = leftoverArrival, .selectNext = heapFront,
+        .onComplete = indexedComplete, .preempts = leftoverPreempts},
+    {.cName = "MLFQ", .iQuantum = 1, .init = mlfqInit, .onArrival = mlfqArrival, .selectNext = mlfqSelect,
+        .slice = mlfqSlice, .onQuantum = mlfqQuantum, .preempts = mlfqPreempts},
+    {.cName = NULL}
+};
+
+struct Policy *findPolicy(char *cAlgorithm) {
+    for (int i = 0;Policies[i].cName != NULL;i++) {
+        if (strcmp(Policies[i].cName, cAlgorithm) == 0) {
+            return &Policies[i];
+        }
+    }
+    return NULL;
+}
+
+
+//------------------------------------------------------------------------------
+//  Sweep Methods
+//------------------------------------------------------------------------------
+//  takes runs off the shared sweep until none are left, simulating each on a
+//  private view of the shared table
+void *sweepWorker(void *arg) {
+    struct Sweep *sweep = arg;
+    struct SweepRun *run;
+    struct ProcessTable *view;
+    struct Arena *arena;
+    struct Engine *engine;
+    int iRun;
+
+    while ((iRun = takeTask(&sweep->tasks)) != -1) {
+        run = &sweep->runs[iRun];
+
+        view = init_table_view(sweep->table);
+        arena = init_arena();
+        engine = init_engine(view, arena);
+        engine->iSwitch = sweep->iSwitch;
+        processQueue(engine, run->cAlgorithm, run->iQuantum);
+        run->count = engine->completed;
+        run->llWait = engine->llWait;
+        run->llTurnover = engine->llTurnover;
+        run->llSwitches = engine->llSwitches;
+        run->llSwitchTime = engine->llSwitchTime;
+        run->llEnd = engine->llEnd;
+        del_arena(arena);
+        del_table(view);
+    }
+    return NULL;
+}
+
+//  ./sched sweep: NPP plus RR for every quantum in [iFirst, iLast], all on the
+//  one table loaded up front and spread over iThreads workers, each paying
+//  iSwitch ms a context switch; the RR quantum finishing processes fastest
+//  is reported once they are done
+int sweep(char *cInputFilepath, char *cSummaryFilepath, int iFirst, int iLast, int iThreads, int iSwitch) {
+    struct Sweep sweep;
+    struct SweepRun *best = NULL;
+    struct ProcessTable *table;
+    FILE *file;
+    int iStatus;
+
+    if (iFirst <= 0 || iLast < iFirst) {
+        printf("Sorry, but a sweep needs quanta running upwards from a positive integer, such as ./sched sweep in.txt summary.txt 1 200\n");
+        return FAIL_QUANTUM;
+    }
+    table = importTrace(cInputFilepath, 0, iThreads, &iStatus);
+    if (table == NULL) {
+        return iStatus;
+    }
+
+    //  sort by arrival once for every run, unless the trace stores the order
+    struct Arena *orderArena = init_arena();
+    if (table->order == NULL) {
+        table->order = init_job_queue(table, orderArena, iThreads)->items;
+    }
+
+    sweep.table = table;
+    sweep.tasks.count = iLast - iFirst + 2;
+    sweep.iSwitch = iSwitch;
+    sweep.runs = malloc(sweep.tasks.count * sizeof(struct SweepRun));
+    if (sweep.runs == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the sweep.");
+        exit(-1);
+    }
+    sweep.runs[0].cAlgorithm = "NPP";
+    sweep.runs[0].iQuantum = 0;
+    for (int i = 1;i < sweep.tasks.count;i++) {
+        sweep.runs[i].cAlgorithm = "RR";
+        sweep.runs[i].iQuantum = iFirst + i - 1;
+    }
+
+    runWorkers(sweepWorker, &sweep.tasks, &sweep, threadCount(iThreads));
+
+    //  the summary comes out in run order, whichever worker finished first
+    file = fopen(cSummaryFilepath, "w");
+    if (file == NULL) {
+        printf("Sorry, but the file %s could not be created.\n", cSummaryFilepath);
+        free(sweep.runs);
+        del_arena(orderArena);
+        del_table(table);
+        return 1;
+    }
+    for (int i = 0;i < sweep.tasks.count;i++) {
+        struct SweepRun *run = &sweep.runs[i];
+        fprintf(file, "%s %d %d %.2f %.2f %lld %lld %lld\n", run->cAlgorithm, run->iQuantum, run->count,
+            run->count > 0 ? (double)run->llWait / run->count : 0.0, run->count > 0 ? (double)run->llTurnover / run->count : 0.0,
+            run->llSwitches, run->llSwitchTime, run->llEnd);
+        //  throughput is processes per ms, compared without dividing
+        if (i > 0 && (best == NULL || (double)run->count * (double)best->llEnd > (double)best->count * (double)run->llEnd)) {
+            best = run;
+        }
+    }
+    fclose(file);
+    if (best != NULL) {
+        printf("The throughput-optimal quantum was %d, finishing %d processes in %lld ms.\n", best->iQuantum, best->count, best->llEnd);
+    }
+    free(sweep.runs);
+    del_arena(orderArena);
+    del_table(table);
+    return 0;
+}
+
+
+//------------------------------------------------------------------------------
+//  Batch Methods
+//------------------------------------------------------------------------------
+//  loads, simulates and writes out one job of a batch just as a single run
+//  would, its queues carved from the worker's arena; returns 1 if it failed
+int batchRun(struct Batch *batch, struct BatchJob *job, struct Arena *arena) {
+    struct ProcessTable *table;
+    struct Engine *engine;
+    struct Writer *writer;
+    FILE *output;
+    int iIndex;
+    int iFailed;
+    int iStatus;
+
+    //  the jobs already share the threads out between them
+    table = importTrace(job->cInputFilepath, job->iLimit, 1, &iStatus);
+    if (table == NULL) {
+        return 1;
+    }
+    output = fopen(job->cOutputFilepath, batch->iBinary ? "wb" : "w");
+    if (output == NULL) {
+        printf("Sorry, but the file %s could not be created.\n", job->cOutputFilepath);
+        del_table(table);
+        return 1;
+    }
+    engine = init_engine(table, arena);
+    engine->iLevels = batch->iLevels;
+    engine->iBoost = batch->iBoost;
+    engine->iSwitch = batch->iSwitch;
+    engine->iSwitching = batch->iSwitching;
+    processQueue(engine, job->run.cAlgorithm, job->run.iQuantum);
+
+    writer = init_writer(output);
+    if (batch->iBinary) { writeResultsHeader(output, engine->completed); }
+    while ((iIndex = dequeue(engine->ProcessQueue)) != -1) {
+        writeResult(writer, batch->iBinary, table->pid[iIndex], table->arrival[iIndex], table->finish[iIndex], table->waiting[iIndex],
+            batch->iSwitching ? table->preemptions[iIndex] : -1);
+    }
+    iFailed = del_writer(writer);
+    if (fclose(output) != 0 || iFailed != 0) {
+        printf("Sorry, but the file %s could not be written.\n", job->cOutputFilepath);
+        iFailed = 1;
+    }
+    job->run.count = engine->completed;
+    job->run.llWait = engine->llWait;
+    job->run.llTurnover = engine->llTurnover;
+    job->run.llSwitches = engine->llSwitches;
+    job->run.llSwitchTime = engine->llSwitchTime;
+    job->run.llEnd = engine->llEnd;
+    del_table(table);
+    return iFailed;
+}
+
+//  takes jobs off the shared batch until none are left, reusing one arena for
+//  all of them rather than allocating every job's queues afresh
+void *batchWorker(void *arg) {
+    struct Batch *batch = arg;
+    struct Arena *arena = init_arena();
+    int iJob;
+
+    while ((iJob = takeTask(&batch->tasks)) != -1) {
+        batch->jobs[iJob].iFailed = batchRun(batch, &batch->jobs[iJob], arena);
+        arenaReset(arena);
+    }
+    del_arena(arena);
+    return NULL;
+}
+
+//  reads every job of a manifest into the batch, one per line of the form
+//      <input filepath> <output filepath> <algorithm> [quantum] [limit]
+//  with blank lines and those starting with # skipped. The paths point into
+//  *cText, which holds the whole manifest until the batch is done. Returns 0,
+//  -1 if the manifest cannot be read, or the number of its first bad line
+int readManifest(char *cManifestFilepath, struct Batch *batch, char **cText) {
+    FILE *file = fopen(cManifestFilepath, "r");
+    char *cFields[5];
+    char *cLine;
+    char *c;
+    struct Policy *policy;
+    size_t size = 0;
+    size_t capacity = LOAD_BLOCK;
+    size_t read;
+    int iFields;
+    int iCapacity = 0;
+    int iLine = 0;
+
+    *cText = NULL;
+    batch->jobs = NULL;
+    batch->tasks.count = 0;
+    if (file == NULL) { return -1; }
+    *cText = malloc(capacity + 1);
+    if (*cText == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the batch.");
+        exit(-1);
+    }
+    while ((read = fread(*cText + size, 1, capacity - size, file)) > 0) {
+        size += read;
+        if (size == capacity) {
+            capacity *= 2;
+            *cText = realloc(*cText, capacity + 1);
+            if (*cText == NULL) {
+                printf("Sorry, but memory was found to be unallocatable for the batch.");
+                exit(-1);
+            }
+        }
+    }
+    fclose(file);
+    (*cText)[size] = '\0';
+
+    //  each line is split in place, its fields ending where the spaces were
+    for (cLine = *cText;*cLine != '\0';cLine = c) {
+        iLine++;
+        iFields = 0;
+        c = cLine;
+        while (*c != '\0' && *c != '\n') {
+            while (*c == ' ' || *c == '\t' || *c == '\r') { *c++ = '\0'; }
+            if (*c == '\0' || *c == '\n') { break; }
+            if (iFields < 5) { cFields[iFields] = c; }
+            iFields++;
+            while (*c != '\0' && *c != '\n' && *c != ' ' && *c != '\t' && *c != '\r') { c++; }
+        }
+        if (*c == '\n') { *c++ = '\0'; }
+        if (iFields == 0 || cFields[0][0] == '#') { continue; }
+
+        //  the same arguments a single run takes after its two paths
+        if (iFields < 3 || iFields > 5 || (policy = findPolicy(cFields[2])) == NULL) { return iLine; }
+        if (policy->iQuantum && (iFields < 4 || parsePositive(cFields[3]) == -1)) { return iLine; }
+        if (!policy->iQuantum && iFields > 4) { return iLine; }
+        if (iFields == (policy->iQuantum ? 5 : 4) && parsePositive(cFields[iFields - 1]) == -1) { return iLine; }
+        if (batch->tasks.count == iCapacity) {
+            iCapacity = (iCapacity > 0) ? iCapacity * 2 : 64;
+            batch->jobs = realloc(batch->jobs, iCapacity * sizeof(struct BatchJob));
+            if (batch->jobs == NULL) {
+                printf("Sorry, but memory was found to be unallocatable for the batch.");
+                exit(-1);
+            }
+        }
+        struct BatchJob *job = &batch->jobs[batch->tasks.count++];
+        memset(job, 0, sizeof(struct BatchJob));
+        job->cInputFilepath = cFields[0];
+        job->cOutputFilepath = cFields[1];
+        job->run.cAlgorithm = policy->cName;
+        if (policy->iQuantum) {
+            job->run.iQuantum = parsePositive(cFields[3]);
+            job->iLimit = (iFields == 5) ? parsePositive(cFields[4]) : 0;
+        } else {
+            job->iLimit = (iFields == 4) ? parsePositive(cFields[3]) : 0;
+        }
+    }
+    return 0;
+}
+
+//  ./sched batch: every job of the manifest, spread over iThreads workers as
+//  a sweep's runs are and each given the options of the command line, with
+//  one summary line per job written in manifest order once all are done:
+//      <input> <algorithm> <quantum> <processes> <average-wait>
+//      <average-turnover> <switches> <switch-time> <finish-time-of-last>
+//  or <input> <algorithm> <quantum> failed. Returns 1 if any job failed
+int batch(char *cManifestFilepath, char *cSummaryFilepath, int iThreads, int iBinary, int iLevels, int iBoost, int iSwitch, int iSwitching) {
+    struct Batch batch;
+    char *cText;
+    FILE *file;
+    int iFailed = 0;
+    int iLine;
+
+    iLine = readManifest(cManifestFilepath, &batch, &cText);
+    if (iLine == -1) {
+        printf("Sorry, but there seems to be no such file at %s.\n", cManifestFilepath);
+        return 1;
+    }
+    if (iLine > 0) {
+        printf("Sorry, but line %d of %s is not of the form <input filepath> <output filepath> <algorithm> [quantum] [limit].\n", iLine, cManifestFilepath);
+        free(batch.jobs);
+        free(cText);
+        return 1;
+    }
+    if (batch.tasks.count == 0) {
+        printf("Sorry, but the manifest %s lists no jobs.\n", cManifestFilepath);
+        free(cText);
+        return 1;
+    }
+    batch.iBinary = iBinary;
+    batch.iLevels = iLevels;
+    batch.iBoost = iBoost;
+    batch.iSwitch = iSwitch;
+    batch.iSwitching = iSwitching;
+
+    //  reported as the workers actually started, never more than the jobs
+    iThreads = threadCount(iThreads);
+    if (iThreads > batch.tasks.count) {
+        iThreads = batch.tasks.count;
+    }
+    runWorkers(batchWorker, &batch.tasks, &batch, iThreads);
+
+    file = fopen(cSummaryFilepath, "w");
+    if (file == NULL) {
+        printf("Sorry, but the file %s could not be created.\n", cSummaryFilepath);
+        free(batch.jobs);
+        free(cText);
+        return 1;
+    }
+    for (int i = 0;i < batch.tasks.count;i++) {
+        struct BatchJob *job = &batch.jobs[i];
+        struct SweepRun *run = &job->run;
+        if (job->iFailed) {
+            fprintf(file, "%s %s %d failed\n", job->cInputFilepath, run->cAlgorithm, run->iQuantum);
+            iFailed++;
+            continue;
+        }
+        fprintf(file, "%s %s %d %d %.2f %.2f %lld %lld %lld\n", job->cInputFilepath, run->cAlgorithm, run->iQuantum, run->count,
+            run->count > 0 ? (double)run->llWait / run->count : 0.0, run->count > 0 ? (double)run->llTurnover / run->count : 0.0,
+            run->llSwitches, run->llSwitchTime, run->llEnd);
+    }
+    if (fclose(file) != 0) {
+        printf("Sorry, but the file %s could not be written.\n", cSummaryFilepath);
+        iFailed++;
+    }
+    printf("The batch ran %d jobs on %d threads, and %d of them failed.\n", batch.tasks.count, iThreads, iFailed);
+    free(batch.jobs);
+    free(cText);
+    return (iFailed > 0) ? 1 : 0;
+}
+
+
+//------------------------------------------------------------------------------
+//  Library Methods
+//------------------------------------------------------------------------------
+//  a live engine for the policy, set up as processQueue() would set up a run
+//  on one CPU but with an empty table, filled as processes are submitted
+struct Sched *sched_create(const char *cPolicy, const struct SchedParams *params) {
+    struct Policy *policy = findPolicy((char *)cPolicy);
+    struct SchedParams none = {0, 0, 0, 0};
+    struct Sched *newSched;
+    struct Engine *engine;
+
+    if (params == NULL) {
+        params = &none;
+    }
+    if (policy == NULL || (policy->iQuantum && params->iQuantum <= 0)
+        || params->iSwitch < 0 || params->iLevels < 0 || params->iLevels > 64) {
+        return NULL;
+    }
+    newSched = malloc(sizeof(struct Sched));
+    if (newSched == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the simulation.");
+        exit(-1);
+    }
+    newSched->arena = init_arena();
+    memset(&newSched->live, 0, sizeof(struct Live));
+    newSched->live.Inbox = init_queue(newSched->arena, 1024);
+    newSched->live.llHorizon = -1;
+    newSched->live.iLatest = -1;
+    newSched->live.iCurrent = -1;
+    newSched->live.iPrevious = -1;
+    //  idle from just before 0, so that an arrival at 0 is still to come
+    newSched->live.CLOCK = -1;
+
+    engine = arenaAlloc(newSched->arena, sizeof(struct Engine));
+    memset(engine, 0, sizeof(struct Engine));
+    engine->table = init_table();
+    engine->arena = newSched->arena;
+    engine->ReadyQueue = init_queue(newSched->arena, 1024);
+    engine->FreeRows = init_queue(newSched->arena, 1024);
+    engine->stats = init_stats(newSched->arena);
+    engine->live = &newSched->live;
+    engine->iLookahead = 1;
+    engine->iCpus = 1;
+    engine->iLevels = params->iLevels;
+    engine->iBoost = params->iBoost;
+    engine->iSwitch = params->iSwitch;
+    engine->iSwitching = 1;
+    engine->policy = policy;
+    engine->iQuantum = policy->iQuantum ? params->iQuantum : 0;
+    if (policy->init != NULL) {
+        policy->init(engine);
+    }
+    newSched->engine = engine;
+    return newSched;
+}
+
+void sched_destroy(struct Sched *sched) {
+    del_table(sched->engine->table);
+    del_arena(sched->arena);
+    free(sched);
+    sched = NULL;
+}
+
+void sched_on_finish(struct Sched *sched, SchedCallback callback, void *context) {
+    sched->live.callback = callback;
+    sched->live.context = context;
+}
+
+//  queues the process behind those already submitted, to be taken into the
+//  lookahead once they have all arrived
+int sched_submit(struct Sched *sched, const struct SchedProcess *process) {
+    struct Live *live = &sched->live;
+    if (process->arrival <= live->llHorizon || process->arrival < live->iLatest || process->burst < 0) {
+        return -1;
+    }
+    live->iLatest = process->arrival;
+    enqueue(live->Inbox, process->pid);
+    enqueue(live->Inbox, process->arrival);
+    enqueue(live->Inbox, process->burst);
+    enqueue(live->Inbox, process->priority);
+    if (!sched->engine->pending) {
+        readAhead(sched->engine);
+    }
+    return 0;
+}
+
+//  simulates everything up to and including t, from wherever the last advance
+//  left off
+int sched_advance_until(struct Sched *sched, long long t) {
+    if (t < sched->live.llHorizon) {
+        return -1;
+    }
+    sched->live.llHorizon = t;
+    schedule(sched->engine);
+    return 0;
+}
+
+//  simulates everything submitted through to its finish; nothing more can be
+//  submitted after
+int sched_drain(struct Sched *sched) {
+    sched->live.llHorizon = LLONG_MAX;
+    schedule(sched->engine);
+    return 0;
+}
+
+void sched_totals(struct Sched *sched, struct SchedTotals *totals) {
+    struct Engine *engine = sched->engine;
+    totals->completed = engine->completed;
+    totals->llWait = engine->llWait;
+    totals->llTurnover = engine->llTurnover;
+    totals->llSwitches = engine->llSwitches;
+    totals->llSwitchTime = engine->llSwitchTime;
+    totals->llEvents = engine->llEvents;
+    totals->llNow = (sched->live.llHorizon < LLONG_MAX) ? sched->live.llHorizon : engine->llEnd;
+}
+
+
+//------------------------------------------------------------------------------
+//  Checkpoint Methods
+//------------------------------------------------------------------------------
+//  a ring's count and then its items from the head, so a restore can lay
+//  them out from 0 at whatever capacity it has
+void checkpointQueue(FILE *file, struct IndexQueue *queue) {
+    int iFirst = queue->capacity - queue->head;
+    fwrite(&queue->count, sizeof(int), 1, file);
+    if (queue->count <= iFirst) {
+        fwrite(queue->items + queue->head, sizeof(int), queue->count, file);
+    } else {
+        fwrite(queue->items + queue->head, sizeof(int), iFirst, file);
+        fwrite(queue->items, sizeof(int), queue->count - iFirst, file);
+    }
+}
+
+//  the ring as checkpointQueue() wrote it; returns 0, or -1 if it is cut short
+//  or, unless iRows is negative, holds an item that is not a row below iRows
+int restoreQueue(FILE *file, struct IndexQueue *queue, int iRows) {
+    int iCount;
+    if (fread(&iCount, sizeof(int), 1, file) != 1 || iCount < 0) { return -1; }
+    if (iCount > queue->capacity) {
+        while (queue->capacity < iCount) {
+            queue->capacity <<= 1;
+        }
+        queue->items = arenaAlloc(queue->arena, queue->capacity * sizeof(int));
+    }
+    queue->head = 0;
+    queue->count = iCount;
+    if (fread(queue->items, sizeof(int), iCount, file) != (size_t)iCount) { return -1; }
+    for (int i = 0;iRows >= 0 && i < iCount;i++) {
+        if (queue->items[i] < 0 || queue->items[i] >= iRows) { return -1; }
+    }
+    return 0;
+}
+
+//  only the buckets up to the last one used, since the rest are all zero
+void checkpointHistogram(FILE *file, struct Histogram *histogram) {
+    int iUsed = HISTOGRAM_BUCKETS;
+    while (iUsed > 0 && histogram->counts[iUsed - 1] == 0) {
+        iUsed--;
+    }
+    fwrite(&iUsed, sizeof(int), 1, file);
+    fwrite(histogram->counts, sizeof(long long), iUsed, file);
+    fwrite(&histogram->count, sizeof(long long), 1, file);
+    fwrite(&histogram->below, sizeof(long long), 1, file);
+    fwrite(&histogram->min, sizeof(long long), 1, file);
+    fwrite(&histogram->max, sizeof(long long), 1, file);
+}
+
+int restoreHistogram(FILE *file, struct Histogram *histogram) {
+    int iUsed;
+    memset(histogram, 0, sizeof(struct Histogram));
+    if (fread(&iUsed, sizeof(int), 1, file) != 1 || iUsed < 0 || iUsed > HISTOGRAM_BUCKETS) { return -1; }
+    if (fread(histogram->counts, sizeof(long long), iUsed, file) != (size_t)iUsed
+        || fread(&histogram->count, sizeof(long long), 1, file) != 1
+        || fread(&histogram->below, sizeof(long long), 1, file) != 1
+        || fread(&histogram->min, sizeof(long long), 1, file) != 1
+        || fread(&histogram->max, sizeof(long long), 1, file) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+//  writes everything a live simulation needs to carry on from where its last
+//  advance stopped, in time proportional to the processes it holds rather
+//  than to those it has ever seen; the callback is not part of it. Returns 0,
+//  or -1 if the checkpoint could not be written
+int sched_checkpoint(struct Sched *sched, FILE *file) {
+    struct Engine *engine = sched->engine;
+    struct ProcessTable *table = engine->table;
+    struct Live *live = &sched->live;
+    struct Mlfq *mlfq = engine->mlfq;
+    struct Stats *stats = engine->stats;
+    struct CheckpointHeader header;
+    struct CheckpointState state;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    strncpy(header.policy, engine->policy->cName, sizeof(header.policy) - 1);
+    header.quantum = engine->iQuantum;
+    header.switchCost = engine->iSwitch;
+    header.levels = engine->iLevels;
+    header.boost = engine->iBoost;
+
+    memset(&state, 0, sizeof(state));
+    state.llEvents = engine->llEvents;
+    state.llWait = engine->llWait;
+    state.llTurnover = engine->llTurnover;
+    state.llSwitches = engine->llSwitches;
+    state.llSwitchTime = engine->llSwitchTime;
+    state.llEnd = engine->llEnd;
+    state.llClock = engine->llClock;
+    state.llHorizon = live->llHorizon;
+    state.CLOCK = live->CLOCK;
+    state.llDispatch = live->llDispatch;
+    state.llStart = live->llStart;
+    state.llEvent = live->llEvent;
+    state.llResponse = stats->llResponse;
+    state.llBusy = stats->llBusy;
+    state.llAdmitted = stats->llAdmitted;
+    state.llMaxReady = stats->llMaxReady;
+    if (mlfq != NULL) {
+        state.llNextBoost = mlfq->nextBoost;
+        state.llPromotions = mlfq->llPromotions;
+        state.llDemotions = mlfq->llDemotions;
+        state.mask = mlfq->mask;
+    }
+    state.count = table->count;
+    state.completed = engine->completed;
+    state.pending = engine->pending;
+    memcpy(state.next, engine->next, sizeof(state.next));
+    state.iUntilScan = engine->iUntilScan;
+    state.iLatest = live->iLatest;
+    state.iCurrent = live->iCurrent;
+    state.iPrevious = live->iPrevious;
+    state.iRunning = live->iRunning;
+    state.iCompleting = live->iCompleting;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&state, sizeof(state), 1, file);
+    //  a simulation yet to be submitted anything has no columns to write
+    if (table->count > 0) {
+        fwrite(table->pid, sizeof(int), table->count, file);
+        fwrite(table->arrival, sizeof(int), table->count, file);
+        fwrite(table->burst, sizeof(int), table->count, file);
+        fwrite(table->priority, sizeof(int), table->count, file);
+        fwrite(table->leftover, sizeof(int), table->count, file);
+        fwrite(table->finish, sizeof(long long), table->count, file);
+        fwrite(table->waiting, sizeof(long long), table->count, file);
+        fwrite(table->started, sizeof(long long), table->count, file);
+        fwrite(table->preemptions, sizeof(int), table->count, file);
+    }
+    checkpointQueue(file, engine->ReadyQueue);
+    checkpointQueue(file, engine->FreeRows);
+    checkpointQueue(file, live->Inbox);
+    for (int i = 0;mlfq != NULL && i < mlfq->count;i++) {
+        checkpointQueue(file, mlfq->Levels[i]);
+    }
+    //  an indexed heap's positions follow from its entries, so are not kept
+    if (engine->ReadyHeap != NULL) {
+        fwrite(&engine->ReadyHeap->count, sizeof(int), 1, file);
+        fwrite(&engine->ReadyHeap->seq, sizeof(int), 1, file);
+        fwrite(engine->ReadyHeap->entries, sizeof(struct HeapEntry), engine->ReadyHeap->count, file);
+    }
+    if (mlfq != NULL) {
+        fwrite(mlfq->level, sizeof(int), table->count, file);
+    }
+    checkpointHistogram(file, &stats->Wait);
+    checkpointHistogram(file, &stats->Turnover);
+    checkpointHistogram(file, &stats->Response);
+    return (fflush(file) == 0 && !ferror(file)) ? 0 : -1;
+}
+
+//  fills the arrays of a freshly created simulation from the rest of a
+//  checkpoint; returns 0, or -1 if it is cut short or inconsistent
+int restoreState(FILE *file, struct Sched *sched, struct CheckpointState *state) {
+    struct Engine *engine = sched->engine;
+    struct ProcessTable *table = engine->table;
+    struct Mlfq *mlfq = engine->mlfq;
+    struct Heap *ReadyHeap = engine->ReadyHeap;
+    size_t count;
+    int iCount;
+
+    if (state->count < 0 || state->completed < 0) { return -1; }
+    for (int i = 0;i < state->count;i++) {
+        tableAppend(table, 0, 0, 0, 0);
+    }
+    count = (size_t)table->count;
+    if (count > 0 && (fread(table->pid, sizeof(int), count, file) != count
+        || fread(table->arrival, sizeof(int), count, file) != count
+        || fread(table->burst, sizeof(int), count, file) != count
+        || fread(table->priority, sizeof(int), count, file) != count
+        || fread(table->leftover, sizeof(int), count, file) != count
+        || fread(table->finish, sizeof(long long), count, file) != count
+        || fread(table->waiting, sizeof(long long), count, file) != count
+        || fread(table->started, sizeof(long long), count, file) != count
+        || fread(table->preemptions, sizeof(int), count, file) != count)) {
+        return -1;
+    }
+    //  every row restored is indexed by, so must lie within, the table, though
+    //  the inbox holds submitted values rather than rows, and iPrevious may
+    //  also be -2 for a CPU left idle
+    if (state->iCurrent < -1 || state->iCurrent >= table->count
+        || state->iPrevious < -2 || state->iPrevious >= table->count) {
+        return -1;
+    }
+    if (restoreQueue(file, engine->ReadyQueue, table->count) != 0 || restoreQueue(file, engine->FreeRows, table->count) != 0
+        || restoreQueue(file, sched->live.Inbox, -1) != 0) {
+        return -1;
+    }
+    for (int i = 0;mlfq != NULL && i < mlfq->count;i++) {
+        if (restoreQueue(file, mlfq->Levels[i], table->count) != 0) { return -1; }
+    }
+    if (ReadyHeap != NULL) {
+        if (fread(&iCount, sizeof(int), 1, file) != 1 || fread(&ReadyHeap->seq, sizeof(int), 1, file) != 1
+            || iCount < 0 || iCount > table->count) {
+            return -1;
+        }
+        if (iCount > ReadyHeap->capacity) {
+            ReadyHeap->capacity = iCount;
+            ReadyHeap->entries = arenaAlloc(engine->arena, iCount * sizeof(struct HeapEntry));
+        }
+        ReadyHeap->count = iCount;
+        if (fread(ReadyHeap->entries, sizeof(struct HeapEntry), iCount, file) != (size_t)iCount) { return -1; }
+        for (int i = 0;i < iCount;i++) {
+            if (ReadyHeap->entries[i].index < 0 || ReadyHeap->entries[i].index >= table->count) { return -1; }
+        }
+        if (ReadyHeap->position != NULL) {
+            if (ReadyHeap->positions < table->count) {
+                ReadyHeap->positions = table->count;
+                ReadyHeap->position = arenaAlloc(engine->arena, ReadyHeap->positions * sizeof(int));
+            }
+            memset(ReadyHeap->position, -1, ReadyHeap->positions * sizeof(int));
+            for (int i = 0;i < iCount;i++) {
+                ReadyHeap->position[ReadyHeap->entries[i].index] = i;
+            }
+        }
+    }
+    if (mlfq != NULL) {
+        if (mlfq->rows < table->count) {
+            mlfq->rows = table->count;
+            mlfq->level = arenaAlloc(engine->arena, mlfq->rows * sizeof(int));
+        }
+        if (fread(mlfq->level, sizeof(int), count, file) != count) { return -1; }
+        for (int i = 0;i < table->count;i++) {
+            if (mlfq->level[i] < 0 || mlfq->level[i] >= mlfq->count) { return -1; }
+        }
+        mlfq->nextBoost = state->llNextBoost;
+        mlfq->llPromotions = state->llPromotions;
+        mlfq->llDemotions = state->llDemotions;
+        mlfq->mask = state->mask;
+    }
+    if (restoreHistogram(file, &engine->stats->Wait) != 0 || restoreHistogram(file, &engine->stats->Turnover) != 0
+        || restoreHistogram(file, &engine->stats->Response) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+//  a new simulation carrying on from a checkpoint, as many times over as
+//  there are what-ifs to follow from it, or NULL if the file is not one
+struct Sched *sched_restore(FILE *file) {
+    struct CheckpointHeader header;
+    struct CheckpointState state;
+    struct SchedParams params;
+    struct Sched *sched;
+    struct Engine *engine;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != CHECKPOINT_VERSION || fread(&state, sizeof(state), 1, file) != 1) {
+        return NULL;
+    }
+    header.policy[sizeof(header.policy) - 1] = '\0';
+    params.iQuantum = header.quantum;
+    params.iSwitch = header.switchCost;
+    params.iLevels = header.levels;
+    params.iBoost = header.boost;
+    sched = sched_create(header.policy, &params);
+    if (sched == NULL) {
+        return NULL;
+    }
+    if (restoreState(file, sched, &state) != 0) {
+        sched_destroy(sched);
+        return NULL;
+    }
+
+    engine = sched->engine;
+    engine->llEvents = state.llEvents;
+    engine->llWait = state.llWait;
+    engine->llTurnover = state.llTurnover;
+    engine->llSwitches = state.llSwitches;
+    engine->llSwitchTime = state.llSwitchTime;
+    engine->llEnd = state.llEnd;
+    engine->llClock = state.llClock;
+    engine->completed = state.completed;
+    engine->pending = state.pending;
+    memcpy(engine->next, state.next, sizeof(state.next));
+    engine->iUntilScan = state.iUntilScan;
+    engine->stats->llResponse = state.llResponse;
+    engine->stats->llBusy = state.llBusy;
+    engine->stats->llAdmitted = state.llAdmitted;
+    engine->stats->llMaxReady = state.llMaxReady;
+    sched->live.llHorizon = state.llHorizon;
+    sched->live.CLOCK = state.CLOCK;
+    sched->live.llDispatch = state.llDispatch;
+    sched->live.llStart = state.llStart;
+    sched->live.llEvent = state.llEvent;
+    sched->live.iLatest = state.iLatest;
+    sched->live.iCurrent = state.iCurrent;
+    sched->live.iPrevious = state.iPrevious;
+    sched->live.iRunning = state.iRunning;
+    sched->live.iCompleting = state.iCompleting;
+    return sched;
+}
+
+
+//------------------------------------------------------------------------------
+//  Profiling Methods
+//------------------------------------------------------------------------------
+//  a monotonic clock for timing the phases of a run or a benchmark
+long long nowNanoseconds() {
+#ifndef _WIN32
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+#else
+    return (long long)clock() * (1000000000LL / CLOCKS_PER_SEC);
+#endif
+}
+
+//  a profile with a cycle, cache miss and branch miss counter of this
+//  process's user time if the kernel allows them, or with wall times alone
+struct Profile *init_profile() {
+    struct Profile *newProfile = calloc(1, sizeof(struct Profile));
+    if (newProfile == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the profile.");
+        exit(-1);
+    }
+#ifdef __linux__
+    static const unsigned long long configs[PROFILE_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    struct perf_event_attr attr;
+    newProfile->iCounting = 1;
+    for (int i = 0;i < PROFILE_COUNTERS;i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        newProfile->counters[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (newProfile->counters[i] == -1) {
+            newProfile->iCounting = 0;
+        }
+    }
+#else
+    for (int i = 0;i < PROFILE_COUNTERS;i++) {
+        newProfile->counters[i] = -1;
+    }
+#endif
+    return newProfile;
+}
+
+void del_profile(struct Profile *profile) {
+#ifdef __linux__
+    for (int i = 0;i < PROFILE_COUNTERS;i++) {
+        if (profile->counters[i] != -1) {
+            close(profile->counters[i]);
+        }
+    }
+#endif
+    free(profile);
+    profile = NULL;
+}
+
+//  the counters as they stand, which only ever count up
+void profileRead(struct Profile *profile, long long *values) {
+    for (int i = 0;i < PROFILE_COUNTERS;i++) {
+        values[i] = 0;
+#ifdef __linux__
+        if (profile->iCounting && read(profile->counters[i], &values[i], sizeof(long long)) != sizeof(long long)) {
+            values[i] = 0;
+        }
+#endif
+    }
+}
+
+//  marks the start of a phase; a NULL profile, that of a run without
+//  --profile, times nothing
+void profileStart(struct Profile *profile) {
+    if (profile == NULL) { return; }
+    profileRead(profile, profile->started);
+    profile->llStarted = nowNanoseconds();
+}
+
+//  adds what was spent since profileStart() to phase
+void profileStop(struct Profile *profile, int phase) {
+    long long values[PROFILE_COUNTERS];
+    if (profile == NULL) { return; }
+    profile->wall[phase] += nowNanoseconds() - profile->llStarted;
+    profileRead(profile, values);
+    for (int i = 0;i < PROFILE_COUNTERS;i++) {
+        profile->counts[phase][i] += values[i] - profile->started[i];
+    }
+    profile->ran[phase] = 1;
+}
+
+//  one line per phase that ran, a streamed run having parsed its input as it
+//  simulated
+void printProfile(struct Profile *profile, int iStream) {
+    static const char *cPhases[PROFILE_PHASES] = {"Parsing", "Sorting", "Simulating", "Exporting"};
+    for (int i = 0;i < PROFILE_PHASES;i++) {
+        if (!profile->ran[i]) { continue; }
+        printf("%s%s took %.3f ms", cPhases[i], (i == PROFILE_SIMULATE && iStream) ? " (and parsing)" : "", (double)profile->wall[i] / 1e6);
+        if (profile->iCounting) {
+            printf(", %lld cycles, %lld cache misses and %lld branch misses", profile->counts[i][0], profile->counts[i][1], profile->counts[i][2]);
+        }
+        printf(".\n");
+    }
+    if (!profile->iCounting) {
+        printf("No hardware counters could be opened here, so only the wall times are given.\n");
+    }
+}
+
+
+//------------------------------------------------------------------------------
+//  Benchmark Methods
+//------------------------------------------------------------------------------
+//  splitmix64, so that a seed always gives the same trace on every platform
+unsigned long long benchRandom(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+//  writes iCount processes as a text input file: arrivals a Poisson process
+//  of BENCH_RATE per ms, found a ms at a time by Knuth's method, bursts
+//  Pareto with a shape of 2 (the least integer b with b * b >= 4 / u for u
+//  uniform on (0, 1], so averaging about 4.5 ms with an unbounded variance)
+//  and priorities uniform from 0 to 9. The offered load is a little over 1,
+//  and the first process runs 1000 ms, so the ready queue never drains
+//  (a run ends the first moment the CPU is idle)
+void generateTrace(FILE *file, int iCount, unsigned long long seed) {
+    struct Writer *writer = init_writer(file);
+    unsigned long long state = seed;
+    unsigned long long uSquare;
+    unsigned long long uRoot;
+    long long llArrival = 0;
+    int iArrivals = 0;
+    double dUniform;
+    double dProduct;
+    int iBurst;
+
+    for (int i = 0;i < iCount;i++) {
+        //  the next ms with an arrival, and how many more arrive then
+        while (i > 0 && iArrivals == 0) {
+            llArrival++;
+            dProduct = 1.0;
+            iArrivals = -1;
+            do {
+                dProduct *= (double)((benchRandom(&state) >> 11) + 1) / 9007199254740992.0;
+                iArrivals++;
+            } while (dProduct > BENCH_RATE_EXP);
+        }
+        if (i > 0) {
+            iArrivals--;
+        }
+        dUniform = (double)((benchRandom(&state) >> 11) + 1) / 9007199254740992.0;
+        uSquare = (unsigned long long)(4.0 / dUniform);
+        uRoot = 1ULL << (highestBit(uSquare) / 2 + 1);
+        while (uRoot * uRoot > uSquare) {
+            uRoot = (uRoot + uSquare / uRoot) / 2;
+        }
+        if (uRoot * uRoot < uSquare) {
+            uRoot++;
+        }
+        iBurst = (i == 0) ? 1000 : (int)uRoot;
+        if (writer->used + 64 > WRITE_BLOCK) {
+            writerFlush(writer);
+        }
+        writeInt(writer, i + 1);
+        writer->buffer[writer->used++] = ' ';
+        writeInt(writer, llArrival);
+        writer->buffer[writer->used++] = ' ';
+        writeInt(writer, iBurst);
+        writer->buffer[writer->used++] = ' ';
+        writeInt(writer, (long long)(benchRandom(&state) % 10));
+        writer->buffer[writer->used++] = '\n';
+    }
+    del_writer(writer);
+}
+
+//  ./sched generate: a synthetic trace of iCount processes, as bench uses
+int generate(int iCount, char *cFilepath, unsigned long long seed) {
+    FILE *file;
+    if (iCount <= 0) {
+        printf("Sorry, but a trace needs a positive number of processes, such as ./sched generate 1000 in.txt\n");
+        return 1;
+    }
+    file = fopen(cFilepath, "w");
+    if (file == NULL) {
+        printf("Sorry, but the file %s could not be created.\n", cFilepath);
+        return 1;
+    }
+    generateTrace(file, iCount, seed);
+    if (fclose(file) != 0) {
+        printf("Sorry, but the file %s could not be written.\n", cFilepath);
+        return 1;
+    }
+    return 0;
+}
+
+//  the most memory the process has held at once, in KB, or 0 if unknown
+long benchPeakKilobytes() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+//  a policy's key for the reference's ready list: lower runs first, with
+//  ties going to whichever joined the list first
+long long referenceKey(struct ProcessTable *table, struct Reference *reference, int index) {
+    switch (reference->iKey) {
+        case 1: return table->priority[index];
+        case 2: return table->burst[index];
+        case 3: return reference->left[index];
+        case 4: return reference->level[index];
+        default: return 0;
+    }
+}
+
+//  puts a process at the end of the ready list, which is so always in the
+//  order processes joined it
+void referencePush(struct Reference *reference, int index) {
+    reference->ready[reference->readyCount++] = index;
+    reference->inReady[index] = 1;
+}
+
+void referenceRemove(struct Reference *reference, int iPosition) {
+    reference->inReady[reference->ready[iPosition]] = 0;
+    memmove(&reference->ready[iPosition], &reference->ready[iPosition + 1], (reference->readyCount - iPosition - 1) * sizeof(int));
+    reference->readyCount--;
+}
+
+//  position in the ready list of the first process with the lowest key
+int referenceBest(struct ProcessTable *table, struct Reference *reference) {
+    int iBest = 0;
+    for (int i = 1;i < reference->readyCount;i++) {
+        if (referenceKey(table, reference, reference->ready[i]) < referenceKey(table, reference, reference->ready[iBest])) {
+            iBest = i;
+        }
+    }
+    return iBest;
+}
+
+//  admits the processes arriving at tick t, dropping those that arrived
+//  before it unseen; returns how many arrived
+int referenceAdmit(struct ProcessTable *table, struct Reference *reference, long long t) {
+    int iAdmitted = 0;
+    while (reference->next < table->count - 1 && table->arrival[reference->order[reference->next]] < t) {
+        reference->next++;
+    }
+    while (reference->next < table->count - 1 && table->arrival[reference->order[reference->next]] == t) {
+        reference->level[reference->order[reference->next]] = 0;
+        referencePush(reference, reference->order[reference->next++]);
+        iAdmitted++;
+    }
+    return iAdmitted;
+}
+
+//  the process to run next at tick t, after any MLFQ boost that has come due,
+//  or -1 if none is ready; PP and SRTF leave it on the list while it runs
+int referenceSelect(struct ProcessTable *table, struct Reference *reference, long long t) {
+    int iPosition;
+    int iIndex;
+    int iKept = 0;
+    if (reference->iLevels > 0 && reference->boost > 0 && t >= reference->nextBoost) {
+        //  every level moves to the top in turn, keeping its order
+        for (int l = 0;l < reference->iLevels;l++) {
+            for (int i = 0;i < reference->readyCount;i++) {
+                if (reference->level[reference->ready[i]] == l) {
+                    reference->scratch[iKept++] = reference->ready[i];
+                }
+            }
+        }
+        memcpy(reference->ready, reference->scratch, iKept * sizeof(int));
+        for (int i = 0;i < reference->readyCount;i++) {
+            reference->level[reference->ready[i]] = 0;
+        }
+        reference->nextBoost = (t / reference->boost + 1) * reference->boost;
+    }
+    if (reference->readyCount == 0) { return -1; }
+    iPosition = referenceBest(table, reference);
+    iIndex = reference->ready[iPosition];
+    if (!reference->iKeep) {
+        referenceRemove(reference, iPosition);
+    }
+    return iIndex;
+}
+
+//  whether the running process must give way to one now ready: under PP and
+//  SRTF one with a lower key, under MLFQ one at a higher level
+int referenceOutranked(struct ProcessTable *table, struct Reference *reference, int index) {
+    if (reference->iKeep) {
+        if (!reference->inReady[index]) {
+            referencePush(reference, index);
+        }
+        return referenceKey(table, reference, reference->ready[referenceBest(table, reference)]) < referenceKey(table, reference, index);
+    }
+    if (reference->iLevels > 0) {
+        for (int i = 0;i < reference->readyCount;i++) {
+            if (reference->level[reference->ready[i]] < reference->level[index]) {
+                referencePush(reference, index);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+void referenceFinish(struct Reference *reference, int index, long long t) {
+    reference->finish[index] = t;
+    reference->done[index] = 1;
+    reference->completed++;
+    for (int i = 0;i < reference->readyCount;i++) {
+        if (reference->ready[i] == index) {
+            referenceRemove(reference, i);
+            break;
+        }
+    }
+}
+
+//  runs the table the way the original simulator did, a tick at a time, with
+//  every choice a scan of one ready list, for bench to check the engine by
+struct Reference *init_reference(struct ProcessTable *table, char *cAlgorithm, int iQuantum, int iSwitch, int iLevels, int iBoost) {
+    struct Reference *reference = calloc(1, sizeof(struct Reference));
+    size_t rows = (size_t)table->count + 1;
+    long long llSlice;
+    long long llUsed;
+    long long t = 0;
+    int iCurrent = (table->count > 0) ? 0 : -1;
+    int iPrevious = -1;
+    int iPosition;
+
+    if (reference == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the reference run.");
+        exit(-1);
+    }
+    reference->order = malloc(rows * sizeof(int));
+    reference->left = malloc(rows * sizeof(int));
+    reference->level = calloc(rows, sizeof(int));
+    reference->ready = malloc(rows * sizeof(int));
+    reference->scratch = malloc(rows * sizeof(int));
+    reference->inReady = calloc(rows, sizeof(int));
+    reference->done = calloc(rows, sizeof(int));
+    reference->preemptions = calloc(rows, sizeof(int));
+    reference->finish = calloc(rows, sizeof(long long));
+    if (reference->order == NULL || reference->left == NULL || reference->level == NULL || reference->ready == NULL || reference->scratch == NULL
+        || reference->inReady == NULL || reference->done == NULL || reference->preemptions == NULL || reference->finish == NULL) {
+        printf("Sorry, but memory was found to be unallocatable for the reference run.");
+        exit(-1);
+    }
+    memcpy(reference->left, table->burst, (size_t)table->count * sizeof(int));
+    //  insertion sort by arrival, which keeps ties in input order
+    for (int i = 1;i < table->count;i++) {
+        iPosition = i - 1;
+        while (iPosition > 0 && table->arrival[reference->order[iPosition - 1]] > table->arrival[i]) {
+            reference->order[iPosition] = reference->order[iPosition - 1];
+            iPosition--;
+        }
+        reference->order[iPosition] = i;
+    }
+    if (strcmp(cAlgorithm, "NPP") == 0 || strcmp(cAlgorithm, "PP") == 0) {
+        reference->iKey = 1;
+    } else if (strcmp(cAlgorithm, "SJF") == 0) {
+        reference->iKey = 2;
+    } else if (strcmp(cAlgorithm, "SRTF") == 0) {
+        reference->iKey = 3;
+    } else if (strcmp(cAlgorithm, "MLFQ") == 0) {
+        reference->iKey = 4;
+        reference->iLevels = (iLevels > 0) ? iLevels : 3;
+        reference->quantum = malloc(reference->iLevels * sizeof(long long));
+        if (reference->quantum == NULL) {
+            printf("Sorry, but memory was found to be unallocatable for the reference run.");
+            exit(-1);
+        }
+        for (int l = 0;l < reference->iLevels;l++) {
+            reference->quantum[l] = (l == 0) ? iQuantum : 2 * reference->quantum[l - 1];
+            if (reference->quantum[l] > INT_MAX) {
+                reference->quantum[l] = INT_MAX;
+            }
+        }
+        if (iBoost != 0) {
+            reference->boost = (iBoost > 0) ? iBoost : 0;
+        } else {
+            reference->boost = (10 * reference->quantum[reference->iLevels - 1] < INT_MAX) ? 10 * reference->quantum[reference->iLevels - 1] : INT_MAX;
+        }
+        reference->nextBoost = reference->boost;
+    }
+    reference->iKeep = (reference->iKey == 1 && strcmp(cAlgorithm, "PP") == 0) || reference->iKey == 3;
+
+    while (iCurrent != -1) {
+        if (iPrevious != -1 && iCurrent != iPrevious) {
+            if (iPrevious >= 0) {
+                reference->preemptions[iPrevious]++;
+            }
+            reference->llSwitches++;
+            for (int i = 0;i < iSwitch;i++) {
+                referenceAdmit(table, reference, ++t);
+            }
+            if (iSwitch > 0 && referenceOutranked(table, reference, iCurrent)) {
+                iPrevious = iCurrent;
+                iCurrent = referenceSelect(table, reference, t);
+                continue;
+            }
+        }
+        iPrevious = iCurrent;
+        if (strcmp(cAlgorithm, "RR") == 0) {
+            llSlice = iQuantum;
+        } else if (reference->iLevels > 0) {
+            llSlice = reference->quantum[reference->level[iCurrent]];
+        } else {
+            llSlice = LLONG_MAX;
+        }
+        if (reference->left[iCurrent] <= 0) {
+            referenceAdmit(table, reference, t);
+            referenceFinish(reference, iCurrent, t);
+            iPrevious = -2;
+            iCurrent = referenceSelect(table, reference, t);
+            continue;
+        }
+        for (llUsed = 1;;llUsed++) {
+            t++;
+            if (--reference->left[iCurrent] == 0) {
+                referenceAdmit(table, reference, t);
+                referenceFinish(reference, iCurrent, t);
+                iPrevious = -2;
+                iCurrent = referenceSelect(table, reference, t);
+                break;
+            }
+            //  arrivals at the instant a quantum expires go behind the process
+            if (llUsed == llSlice) {
+                if (reference->iLevels > 0 && reference->level[iCurrent] < reference->iLevels - 1) {
+                    reference->level[iCurrent]++;
+                }
+                referencePush(reference, iCurrent);
+                referenceAdmit(table, reference, t);
+                iCurrent = referenceSelect(table, reference, t);
+                break;
+            }
+            if (referenceAdmit(table, reference, t) > 0 && referenceOutranked(table, reference, iCurrent)) {
+                iCurrent = referenceSelect(table, reference, t);
+                break;
+            }
+        }
+    }
+    return reference;
+}
+
+void del_reference(struct Reference *reference) {
+    free(reference->order);
+    free(reference->left);
+    free(reference->level);
+    free(reference->ready);
+    free(reference->scratch);
+    free(reference->inReady);
+    free(reference->done);
+    free(reference->preemptions);
+    free(reference->finish);
+    free(reference->quantum);
+    free(reference);
+    reference = NULL;
+}
+
+//  the pid of the first process the engine finished differently from the
+//  reference (or -1 if they agree entirely), counting the preemptions too
+//  when switches were modelled; a difference only in the totals gives 0, as
+//  does one between the totals sumTotals() made and the scalar loop's
+int referenceCompare(struct Engine *engine, struct Reference *reference) {
+    struct ProcessTable *table = engine->table;
+    struct IndexQueue *ProcessQueue = engine->ProcessQueue;
+    long long totals[2] = {0, 0};
+    int iIndex;
+    for (int i = 0;i < ProcessQueue->count;i++) {
+        iIndex = ProcessQueue->items[(ProcessQueue->head + i) & (ProcessQueue->capacity - 1)];
+        if (!reference->done[iIndex] || reference->finish[iIndex] != table->finish[iIndex]
+            || (engine->iSwitching && reference->preemptions[iIndex] != table->preemptions[iIndex])) {
+            return table->pid[iIndex];
+        }
+    }
+    sumTotalsScalar(table->finish, table->started, table->arrival, table->burst, 0, table->count, totals);
+    if (reference->completed != engine->completed || (engine->iSwitching && reference->llSwitches != engine->llSwitches)
+        || totals[0] != engine->llTurnover || totals[1] != engine->llWait) {
+        return 0;
+    }
+    return -1;
+}
+
+//  ./sched bench: for every size from iFirst processes to iLast, ten times
+//  larger at each step, generates a trace from seed and times loading it,
+//  then simulating every policy on it and writing the results, which for up
+//  to BENCH_CHECK processes are checked against the tick-based reference;
+//  returns 1 if any of them differ
+int bench(int iFirst, int iLast, int iQuantum, unsigned long long seed, int iSwitch, int iSwitching, int iLevels, int iBoost) {
+    struct ProcessTable *table;
+    struct ProcessTable *view;
+    struct Arena *orderArena;
+    struct Arena *arena;
+    struct Engine *engine;
+    struct Reference *reference;
+    struct IndexQueue *ProcessQueue;
+    struct Writer *writer;
+    FILE *file;
+    long long llStart;
+    long long llSimulated;
+    long long llWritten;
+    int iDiffering = 0;
+    int iMismatch;
+    int iIndex;
+
+    if (iFirst <= 0 || iLast < iFirst || iQuantum <= 0) {
+        printf("Sorry, but a benchmark needs sizes running upwards from a positive integer and a positive quantum, such as ./sched bench 1000 1000000 4\n");
+        return (iQuantum <= 0) ? FAIL_QUANTUM : 1;
+    }
+    for (long long llSize = iFirst;llSize <= iLast;llSize *= 10) {
+        file = tmpfile();
+        if (file == NULL) {
+            printf("Sorry, but no temporary file could be created for the benchmark's trace.\n");
+            return 1;
+        }
+        generateTrace(file, (int)llSize, seed);
+        rewind(file);
+        llStart = nowNanoseconds();
+        table = init_table();
+        loadTrace(file, table, 0);
+        orderArena = init_arena();
+        table->order = init_job_queue(table, orderArena, 1)->items;
+        printf("%lld processes (seed %llu) loaded and sorted in %.3f ms.\n", llSize, seed, (double)(nowNanoseconds() - llStart) / 1e6);
+        fclose(file);
+
+        for (int p = 0;Policies[p].cName != NULL;p++) {
+            view = init_table_view(table);
+            arena = init_arena();
+            engine = init_engine(view, arena);
+            engine->iSwitch = iSwitch;
+            engine->iSwitching = iSwitching;
+            engine->iLevels = iLevels;
+            engine->iBoost = iBoost;
+            llStart = nowNanoseconds();
+            processQueue(engine, Policies[p].cName, iQuantum);
+            llSimulated = nowNanoseconds() - llStart;
+
+            //  written as a run writes them, but without using them up
+            ProcessQueue = engine->ProcessQueue;
+            file = tmpfile();
+            if (file == NULL) {
+                printf("Sorry, but no temporary file could be created for the benchmark's results.\n");
+                return 1;
+            }
+            llStart = nowNanoseconds();
+            writer = init_writer(file);
+            for (int i = 0;i < ProcessQueue->count;i++) {
+                iIndex = ProcessQueue->items[(ProcessQueue->head + i) & (ProcessQueue->capacity - 1)];
+                writeResult(writer, 0, view->pid[iIndex], view->arrival[iIndex], view->finish[iIndex], view->waiting[iIndex],
+                    iSwitching ? view->preemptions[iIndex] : -1);
+            }
+            del_writer(writer);
+            fclose(file);
+            llWritten = nowNanoseconds() - llStart;
+
+            printf("%-4s ran %lld events in %.3f ms (%.1f ns each), finishing %d processes, whose results were written in %.3f ms",
+                Policies[p].cName, engine->llEvents, (double)llSimulated / 1e6,
+                (engine->llEvents > 0) ? (double)llSimulated / (double)engine->llEvents : 0.0, engine->completed, (double)llWritten / 1e6);
+            if (llSize <= BENCH_CHECK) {
+                reference = init_reference(table, Policies[p].cName, iQuantum, iSwitch, iLevels, iBoost);
+                iMismatch = referenceCompare(engine, reference);
+                del_reference(reference);
+                if (iMismatch == -1) {
+                    printf(", matching the tick-based reference.\n");
+                } else if (iMismatch == 0) {
+                    printf(", but NOT matching the tick-based reference in its totals.\n");
+                    iDiffering = 1;
+                } else {
+                    printf(", but NOT matching the tick-based reference from pid %d.\n", iMismatch);
+                    iDiffering = 1;
+                }
+            } else {
+                printf(".\n");
+            }
+            del_arena(arena);
+            del_table(view);
+        }
+        printf("The peak resident memory so far is %ld KB.\n", benchPeakKilobytes());
+        del_arena(orderArena);
+        del_table(table);
     }
-    del_list(ReadyQueue);
-    return ProcessQueue;
+    return iDiffering;
 }
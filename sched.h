@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * sched.h      Author: Ian Nobile
+ *
+ * The library interface of sched.c, which, compiled with SCHED_NO_MAIN
+ * defined, leaves out main() so as to be linked into another program:
+ *
+ *    cc -O2 -DSCHED_NO_MAIN -c sched.c
+ *
+ * A simulation is created for one of the algorithms the program simulates,
+ * and is then fed processes as they arrive and advanced as far as the caller
+ * likes, never simulating any stretch twice:
+ *
+ *    struct Sched *sched = sched_create("RR", &params);
+ *    sched_on_finish(sched, callback, context);
+ *    sched_submit(sched, &process);
+ *    sched_advance_until(sched, 1000);
+ *
+ * Processes must be submitted in order of arrival, each arriving after the
+ * time last advanced to, and advancing to a time promises that everything
+ * arriving by then has been submitted. Each finish is reported through the
+ * callback as it is simulated. Unlike a run of the program, which ends at the
+ * first idle moment, the CPU of a live simulation waits out idle stretches
+ * for the next arrival, until sched_drain() finishes whatever is left.
+ *
+ * Wherever an advance stops, sched_checkpoint() can write the whole state of
+ * the simulation to a compact binary file, and sched_restore() reads it back
+ * as a new simulation carrying on from there. A checkpoint may be restored
+ * any number of times to follow different what-ifs from the same point, each
+ * needing its callback set again:
+ *
+ *    sched_checkpoint(sched, file);
+ *    struct Sched *branch = sched_restore(file);
+ *
+*******************************************************************************/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  a live simulation, made by sched_create() and freed by sched_destroy()
+struct Sched;
+
+//  the quantum of RR and MLFQ, the cost of a context switch, and MLFQ's
+//  levels and boost period, as given by the options of the program; zero
+//  leaves each as the program would without its option
+struct SchedParams {
+    int iQuantum;
+    int iSwitch;
+    int iLevels;
+    int iBoost;
+};
+
+//  one process, as on a line of an input file
+struct SchedProcess {
+    int pid;
+    int arrival;
+    int burst;
+    int priority;
+};
+
+//  one finished process, as on a line of a results file
+struct SchedResult {
+    int pid;
+    int arrival;
+    long long finish;
+    long long waiting;
+    int preemptions;
+};
+
+//  the totals of everything finished so far, the time simulated up to, and
+//  the events the simulation has taken to get there
+struct SchedTotals {
+    int completed;
+    long long llWait;
+    long long llTurnover;
+    long long llSwitches;
+    long long llSwitchTime;
+    long long llNow;
+    long long llEvents;
+};
+
+typedef void (*SchedCallback)(void *context, const struct SchedResult *result);
+
+//  NULL if the policy is not one the program simulates, or lacks its quantum
+struct Sched *sched_create(const char *cPolicy, const struct SchedParams *params);
+void sched_destroy(struct Sched *sched);
+void sched_on_finish(struct Sched *sched, SchedCallback callback, void *context);
+//  each returns 0, or -1 for a process or time out of order, or a process
+//  with a negative burst
+int sched_submit(struct Sched *sched, const struct SchedProcess *process);
+int sched_advance_until(struct Sched *sched, long long t);
+int sched_drain(struct Sched *sched);
+void sched_totals(struct Sched *sched, struct SchedTotals *totals);
+//  0, or -1 if the checkpoint could not be written
+int sched_checkpoint(struct Sched *sched, FILE *file);
+//  NULL if the file holds no complete checkpoint
+struct Sched *sched_restore(FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif